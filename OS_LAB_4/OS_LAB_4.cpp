@@ -3,22 +3,79 @@
 #include <string>
 #include "receiver.h"
 #include "sender.h"
+#include "subscriber.h"
+#include "pingpong.h"
+#include "placement.h"
+#include "queue_registry.h"
 
 using namespace std;
 
+static void printUsage() {
+    cout << "Usage:\n"
+        << "  OS_LAB_4.exe [options]  - run Receiver\n"
+        << "  OS_LAB_4.exe broadcast [options] - run Receiver with broadcast (fan-out) queue\n"
+        << "  OS_LAB_4.exe sender <file> <id> [--queue <name>] - run Sender\n"
+        << "  OS_LAB_4.exe subscriber <file> <id> [--queue <name>] - run Subscriber of broadcast queue\n"
+        << "  OS_LAB_4.exe pingpong <file> <n> [options] - measure request/reply round-trip latency\n"
+        << "  OS_LAB_4.exe list       - list live queues with their stats\n"
+        << "Options:\n"
+        << "  --queue <name>          - queue name for kernel objects (default: derived from the file path)\n"
+        << "  --pin-receiver <spec>   - pin Receiver and map the queue on its node (in pingpong: pin the echo server only)\n"
+        << "  --pin-senders <spec>[/<spec>...] - pin Senders round-robin\n"
+        << "  --overflow <policy>     - block[:<ms>], drop-oldest, drop-newest or fail when the queue is full\n"
+        << "  <spec> is any, node:<n> or cpu:<list>, e.g. cpu:0,2-3\n";
+}
+
+static void selectQueue(const string& filename, const LaunchOptions& options) {
+    setQueueNamespace(options.queueName.empty() ? queueNameFromPath(filename) : options.queueName);
+}
+
 int main(int argc, char* argv[]) {
-    if (argc == 1) {
-        runReceiver();
+    string mode = argc > 1 ? argv[1] : "";
+    LaunchOptions options;
+    int iterations = 0;
+
+    if (argc == 1 || mode.compare(0, 2, "--") == 0) {
+        if (parseLaunchOptions(argc, argv, 1, options)) {
+            runReceiver(false, options);
+        }
+        else {
+            printUsage();
+        }
     }
-    else if (argc == 4 && string(argv[1]) == "sender") {
+    else if (mode == "broadcast") {
+        if (parseLaunchOptions(argc, argv, 2, options)) {
+            runReceiver(true, options);
+        }
+        else {
+            printUsage();
+        }
+    }
+    else if (argc >= 4 && mode == "sender" && parseLaunchOptions(argc, argv, 4, options)) {
         string filename = argv[2];
         int id = stoi(argv[3]);
+        selectQueue(filename, options);
         runSender(filename, id);
     }
+    else if (argc >= 4 && mode == "subscriber" && parseLaunchOptions(argc, argv, 4, options)) {
+        string filename = argv[2];
+        int id = stoi(argv[3]);
+        selectQueue(filename, options);
+        runSubscriber(filename, id);
+    }
+    else if (argc >= 4 && mode == "pingpong" && parsePingPongCount(argv[3], iterations) && parseLaunchOptions(argc, argv, 4, options)) {
+        selectQueue(argv[2], options);
+        runPingPongBenchmark(argv[2], iterations, options);
+    }
+    else if (argc >= 3 && mode == "echo" && parseLaunchOptions(argc, argv, 3, options)) {
+        selectQueue(argv[2], options);
+        runEchoServer(argv[2]);
+    }
+    else if (argc == 2 && mode == "list") {
+        listQueues();
+    }
     else {
-        cout << "Usage:\n"
-            << "  OS_LAB_4.exe            - run Receiver\n"
-            << "  OS_LAB_4.exe sender <file> <id> - run Sender\n";
+        printUsage();
     }
 
     return 0;
@@ -0,0 +1,138 @@
+#include "async_queue.h"
+
+static EnqueueResult tryPush(PushAwaiter& op) {
+    AsyncQueue& queue = op.queue;
+    QueueHeader q;
+
+    EnqueueResult result = tryEnqueueMessage(queue.hFile, queue.hMutex, queue.evNotFull, queue.evNotEmpty, op.message, op.meta, q);
+    op.ok = result == ENQUEUE_OK;
+    return result;
+}
+
+static TakeResult tryPop(PopAwaiter& op) {
+    AsyncQueue& queue = op.queue;
+    char buffer[MSG_SIZE + 1] = { 0 };
+    DWORD wakeAfter = INFINITE;
+    HANDLE hOwner = NULL;
+
+    TakeResult result = tryDequeueMessage(queue.hFile, queue.hMutex, queue.evNotEmpty, queue.evNotFull, buffer, op.meta,
+        { MATCH_ANY, 0 }, &hOwner, &wakeAfter);
+    queue.wakeAfter = min(queue.wakeAfter, wakeAfter);
+    if (hOwner) {
+        cleanupHandles({ queue.hOwner });
+        queue.hOwner = hOwner;
+    }
+
+    if (result == TAKE_OK) {
+        op.message = buffer;
+    }
+    op.ok = result == TAKE_OK;
+    return result;
+}
+
+static bool isFinished(TakeResult result) {
+    return result == TAKE_OK || result == TAKE_ERROR;
+}
+
+bool PushAwaiter::await_ready() {
+    return queue.pushers.empty() && tryPush(*this) != ENQUEUE_FULL;
+}
+
+void PushAwaiter::await_suspend(coroutine_handle<> waiter) {
+    queue.pushers.push_back({ waiter, this });
+}
+
+bool PopAwaiter::await_ready() {
+    return queue.poppers.empty() && isFinished(tryPop(*this));
+}
+
+void PopAwaiter::await_suspend(coroutine_handle<> waiter) {
+    queue.poppers.push_back({ waiter, this });
+}
+
+static void resumePoppers(AsyncQueue& queue) {
+    queue.wakeAfter = INFINITE;
+
+    while (!queue.poppers.empty() && isFinished(tryPop(*queue.poppers.front().op))) {
+        queue.ready.push_back(queue.poppers.front().waiter);
+        queue.poppers.pop_front();
+    }
+}
+
+static void resumePushers(AsyncQueue& queue) {
+    while (!queue.pushers.empty() && tryPush(*queue.pushers.front().op) != ENQUEUE_FULL) {
+        queue.ready.push_back(queue.pushers.front().waiter);
+        queue.pushers.pop_front();
+    }
+}
+
+void spawnQueueTask(AsyncQueue& queue, QueueTask task) {
+    queue.tasks.push_back(task.handle);
+    queue.ready.push_back(task.handle);
+}
+
+int runQueueTasks(AsyncQueue& queue, DWORD idleTimeout) {
+    while (true) {
+        while (!queue.ready.empty()) {
+            coroutine_handle<> task = queue.ready.front();
+            queue.ready.pop_front();
+            task.resume();
+        }
+
+        if (queue.pushers.empty() && queue.poppers.empty()) {
+            break;
+        }
+
+        vector<HANDLE> events;
+        if (!queue.poppers.empty()) {
+            events.push_back(queue.evNotEmpty);
+            if (queue.hOwner) {
+                events.push_back(queue.hOwner);
+            }
+        }
+        if (!queue.pushers.empty()) {
+            events.push_back(queue.evNotFull);
+        }
+
+        DWORD waitResult = WaitForMultipleObjects((DWORD)events.size(), events.data(), FALSE, min(idleTimeout, queue.wakeAfter));
+        cleanupHandles({ queue.hOwner });
+        queue.hOwner = NULL;
+
+        if (waitResult == WAIT_FAILED) {
+            printError("Failed to wait for queue state");
+            break;
+        }
+        if (waitResult == WAIT_TIMEOUT && queue.wakeAfter >= idleTimeout) {
+            break;
+        }
+
+        resumePoppers(queue);
+        resumePushers(queue);
+    }
+
+    int finished = 0;
+    for (auto it = queue.tasks.begin(); it != queue.tasks.end();) {
+        if (it->done()) {
+            it->destroy();
+            it = queue.tasks.erase(it);
+            finished++;
+        }
+        else {
+            ++it;
+        }
+    }
+    return finished;
+}
+
+void destroyQueueTasks(AsyncQueue& queue) {
+    for (coroutine_handle<> task : queue.tasks) {
+        task.destroy();
+    }
+
+    cleanupHandles({ queue.hOwner });
+    queue.hOwner = NULL;
+    queue.tasks.clear();
+    queue.ready.clear();
+    queue.pushers.clear();
+    queue.poppers.clear();
+}
\ No newline at end of file
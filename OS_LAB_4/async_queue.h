@@ -0,0 +1,81 @@
+#ifndef ASYNC_QUEUE_H
+#define ASYNC_QUEUE_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <coroutine>
+#include <exception>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "sender.h"
+#include "receiver.h"
+
+using namespace std;
+
+struct QueueTask {
+    struct promise_type {
+        QueueTask get_return_object() { return { coroutine_handle<promise_type>::from_promise(*this) }; }
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+
+    coroutine_handle<promise_type> handle;
+};
+
+struct AsyncQueue;
+
+struct PushAwaiter {
+    AsyncQueue& queue;
+    string message;
+    MessageMeta meta;
+    bool ok = false;
+
+    bool await_ready();
+    void await_suspend(coroutine_handle<> waiter);
+    bool await_resume() const { return ok; }
+};
+
+struct PopAwaiter {
+    AsyncQueue& queue;
+    string& message;
+    MessageMeta* meta;
+    bool ok = false;
+
+    bool await_ready();
+    void await_suspend(coroutine_handle<> waiter);
+    bool await_resume() const { return ok; }
+};
+
+template <typename Awaiter>
+struct PendingOperation {
+    coroutine_handle<> waiter;
+    Awaiter* op;
+};
+
+struct AsyncQueue {
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    HANDLE hMutex = NULL;
+    HANDLE evNotEmpty = NULL;
+    HANDLE evNotFull = NULL;
+
+    deque<coroutine_handle<>> ready;
+    deque<PendingOperation<PushAwaiter>> pushers;
+    deque<PendingOperation<PopAwaiter>> poppers;
+    vector<coroutine_handle<>> tasks;
+    DWORD wakeAfter = INFINITE;
+    HANDLE hOwner = NULL;
+
+    PushAwaiter push(const string& message, const MessageMeta& meta = MessageMeta()) { return { *this, message, meta }; }
+    PopAwaiter pop(string& message, MessageMeta* meta = NULL) { return { *this, message, meta }; }
+};
+
+void spawnQueueTask(AsyncQueue& queue, QueueTask task);
+int runQueueTasks(AsyncQueue& queue, DWORD idleTimeout = 5000);
+void destroyQueueTasks(AsyncQueue& queue);
+
+#endif
\ No newline at end of file
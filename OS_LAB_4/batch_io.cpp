@@ -0,0 +1,240 @@
+#include "batch_io.h"
+#include "broadcast.h"
+#include "sender.h"
+#include "overflow.h"
+#include "transaction.h"
+#include "timing_wheel.h"
+
+bool readSlots(HANDLE hFile, const QueueHeader& header, int first, int count, char* slots) {
+    int firstPart = min(count, header.capacity - first);
+
+    if (!readBlock(hFile, slotOffset(header, first), slots, firstPart * SLOT_SIZE, "Failed to read messages.")) {
+        return false;
+    }
+
+    return firstPart == count ||
+        readBlock(hFile, slotOffset(header, 0), slots + firstPart * SLOT_SIZE, (count - firstPart) * SLOT_SIZE,
+            "Failed to read messages.");
+}
+
+bool writeSlots(HANDLE hFile, const QueueHeader& header, int first, int count, const char* slots) {
+    int firstPart = min(count, header.capacity - first);
+
+    if (!writeBlock(hFile, slotOffset(header, first), slots, firstPart * SLOT_SIZE, "Failed to write messages.")) {
+        return false;
+    }
+
+    return firstPart == count ||
+        writeBlock(hFile, slotOffset(header, 0), slots + firstPart * SLOT_SIZE, (count - firstPart) * SLOT_SIZE,
+            "Failed to write messages.");
+}
+
+static bool flushIfDurable(HANDLE hFile, bool durable) {
+    return !durable || flushQueueFile(hFile);
+}
+
+static void fillSlots(vector<char>& slots, const vector<string>& messages, size_t from, int count, const MessageMeta& meta) {
+    slots.assign(count * SLOT_SIZE, 0);
+    SlotHeader slotHeader = { SLOT_READY, meta, 0, 0 };
+
+    for (int i = 0; i < count; ++i) {
+        const string& message = messages[from + i];
+        char* slot = slots.data() + i * SLOT_SIZE;
+
+        memcpy(slot, &slotHeader, sizeof(SlotHeader));
+        memcpy(slot + sizeof(SlotHeader), message.c_str(), min(message.size(), (size_t)MSG_SIZE));
+    }
+}
+
+static size_t enqueueEach(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty,
+    const vector<string>& messages, size_t sent, const MessageMeta& meta, DWORD timeout, int& dropped) {
+    while (sent < messages.size()) {
+        EnqueueResult result = enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, messages[sent], meta, timeout);
+        if (result == ENQUEUE_DROPPED) {
+            dropped++;
+        }
+        else if (result != ENQUEUE_OK) {
+            break;
+        }
+        sent++;
+    }
+    return sent;
+}
+
+int enqueueBatch(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty,
+    const vector<string>& messages, const MessageMeta& meta, bool durable, DWORD timeout, int* dropped) {
+    size_t sent = 0;
+    int lost = 0;
+    vector<char> slots;
+    DWORD started = GetTickCount();
+
+    while (sent < messages.size()) {
+        if (!waitForObject(hMutex, "Waiting for mutex")) {
+            break;
+        }
+
+        QueueHeader q;
+        BroadcastSection section;
+        if (!readQueueHeader(hFile, q) || !readBroadcastSection(hFile, q, section)) {
+            ReleaseMutex(hMutex);
+            break;
+        }
+
+        if (isBroadcastQueue(section)) {
+            ReleaseMutex(hMutex);
+            sent = enqueueEach(hFile, hMutex, evNotFull, evNotEmpty, messages, sent, meta, timeout, lost);
+            break;
+        }
+
+        if (q.count == q.capacity && q.overflowPolicy == OVERFLOW_BLOCK) {
+            ResetEvent(evNotFull);
+            ReleaseMutex(hMutex);
+            if (!waitForSpace(hFile, hMutex, evNotFull, q, started, timeout)) {
+                break;
+            }
+            continue;
+        }
+
+        if (q.count == q.capacity) {
+            ReleaseMutex(hMutex);
+            sent = enqueueEach(hFile, hMutex, evNotFull, evNotEmpty, messages, sent, meta, timeout, lost);
+            break;
+        }
+
+        MessageIndex index;
+        if (!readMessageIndex(hFile, q, index) || !promoteDueMessages(hFile, evNotEmpty, q, index)) {
+            ReleaseMutex(hMutex);
+            break;
+        }
+
+        if (q.count == q.capacity) {
+            ReleaseMutex(hMutex);
+            continue;
+        }
+
+        int count = (int)min(messages.size() - sent, (size_t)min(q.capacity - q.count, MAX_BATCH));
+        fillSlots(slots, messages, sent, count, meta);
+
+        bool ok = appendBatchToIndex(hFile, q, index, q.tail, count, slots.data()) &&
+            writeSlots(hFile, q, q.tail, count, slots.data()) &&
+            writeMessageIndex(hFile, q, index) &&
+            flushIfDurable(hFile, durable);
+
+        if (ok) {
+            q.tail = (q.tail + count) % q.capacity;
+            q.count += count;
+            ok = writeQueueHeader(hFile, q) && flushIfDurable(hFile, durable);
+        }
+
+        ReleaseMutex(hMutex);
+        if (!ok) {
+            break;
+        }
+
+        SetEvent(evNotEmpty);
+        notifyFilterEvents(meta);
+        sent += count;
+        started = GetTickCount();
+    }
+
+    if (dropped) {
+        *dropped = lost;
+    }
+    return (int)sent - lost;
+}
+
+int dequeueBatch(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, int maxMessages,
+    vector<string>& messages, vector<MessageMeta>* metas, DWORD timeout) {
+    vector<char> slots;
+
+    if (maxMessages <= 0) {
+        return 0;
+    }
+
+    HANDLE hOwner = NULL;
+    DWORD wakeAfter = 0;
+    DWORD started = GetTickCount();
+
+    while (true) {
+        bool woken = waitForMessages(evNotEmpty, hOwner, started, timeout, wakeAfter);
+        cleanupHandles({ hOwner });
+        hOwner = NULL;
+
+        if (!woken || !waitForObject(hMutex, "Waiting for mutex")) {
+            return 0;
+        }
+
+        QueueHeader h;
+        MessageIndex index;
+        if (!readQueueHeader(hFile, h) || !readMessageIndex(hFile, h, index) ||
+            !promoteDueMessages(hFile, evNotEmpty, h, index)) {
+            ReleaseMutex(hMutex);
+            return 0;
+        }
+
+        if (index.live == 0) {
+            wakeAfter = delayedWakeTime(hFile, h);
+            ResetEvent(evNotEmpty);
+            ReleaseMutex(hMutex);
+            continue;
+        }
+
+        int scan = min(h.count, min(maxMessages + index.holes, MAX_BATCH));
+        slots.resize(scan * SLOT_SIZE);
+        if (!readSlots(hFile, h, h.head, scan, slots.data())) {
+            ReleaseMutex(hMutex);
+            return 0;
+        }
+
+        int taken = 0;
+        bool blocked = false;
+        for (int i = 0; i < scan && taken < maxMessages; ++i) {
+            const char* slot = slots.data() + i * SLOT_SIZE;
+            SlotHeader sh;
+            memcpy(&sh, slot, sizeof(sh));
+
+            if (sh.state == SLOT_RESERVED) {
+                blocked = true;
+                break;
+            }
+
+            if (sh.state == SLOT_READY) {
+                const char* text = slot + sizeof(SlotHeader);
+                messages.emplace_back(text, strnlen(text, MSG_SIZE));
+                if (metas) {
+                    metas->push_back(sh.meta);
+                }
+                taken++;
+            }
+
+            releaseHeadSlot(h, index, sh);
+        }
+
+        if (blocked && taken == 0) {
+            TakeResult released = releaseAbandonedTransaction(hFile, h, index, h.head);
+            if (released == TAKE_ERROR) {
+                ReleaseMutex(hMutex);
+                return 0;
+            }
+            if (released == TAKE_EMPTY) {
+                hOwner = openReservationOwner(hFile, h, h.head);
+                ResetEvent(evNotEmpty);
+            }
+        }
+
+        if (!skipConsumedAtHead(hFile, h, index) || !writeMessageIndex(hFile, h, index) || !writeQueueHeader(hFile, h)) {
+            ReleaseMutex(hMutex);
+            return 0;
+        }
+
+        if (index.live == 0) {
+            ResetEvent(evNotEmpty);
+        }
+        SetEvent(evNotFull);
+
+        ReleaseMutex(hMutex);
+        if (taken > 0) {
+            return taken;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef BATCH_IO_H
+#define BATCH_IO_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "message_index.h"
+
+using namespace std;
+
+const int MAX_BATCH = 256;
+
+bool readSlots(HANDLE hFile, const QueueHeader& header, int first, int count, char* slots);
+bool writeSlots(HANDLE hFile, const QueueHeader& header, int first, int count, const char* slots);
+
+int enqueueBatch(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty,
+    const vector<string>& messages, const MessageMeta& meta, bool durable, DWORD timeout = 5000, int* dropped = NULL);
+int dequeueBatch(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, int maxMessages,
+    vector<string>& messages, vector<MessageMeta>* metas, DWORD timeout = 5000);
+
+#endif
\ No newline at end of file
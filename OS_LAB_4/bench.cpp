@@ -0,0 +1,208 @@
+#include <windows.h>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "timing_wheel.h"
+
+using namespace std;
+
+const long long BENCH_ITERATIONS = 100000;
+const long long BENCH_WARMUP = 1000;
+const int BENCH_CAPACITIES[] = { 16, 1024, 65536 };
+const int BENCH_BLOCK_SIZES[] = { SLOT_SIZE, 512, 4096 };
+
+struct BenchResult {
+    string primitive;
+    string backend;
+    int capacity;
+    int blockSize;
+    long long iterations;
+    double nanoseconds;
+    ULONG64 cycles;
+};
+
+template <typename Operation>
+static BenchResult measure(const string& primitive, const string& backend, int capacity, int blockSize, long long iterations, Operation op) {
+    for (long long i = 0; i < min(iterations, BENCH_WARMUP); ++i) {
+        op(i);
+    }
+
+    LARGE_INTEGER freq, start, end;
+    ULONG64 cyclesStart = 0, cyclesEnd = 0;
+    QueryPerformanceFrequency(&freq);
+    QueryThreadCycleTime(GetCurrentThread(), &cyclesStart);
+    QueryPerformanceCounter(&start);
+
+    long long done = 0;
+    while (done < iterations && op(done)) {
+        done++;
+    }
+
+    QueryPerformanceCounter(&end);
+    QueryThreadCycleTime(GetCurrentThread(), &cyclesEnd);
+
+    if (done < iterations) {
+        cerr << "Benchmark " << primitive << " (" << backend << ", capacity " << capacity << ") stopped after " << done << " operations\n";
+    }
+
+    return { primitive, backend, capacity, blockSize, done,
+        (end.QuadPart - start.QuadPart) * 1e9 / freq.QuadPart, cyclesEnd - cyclesStart };
+}
+
+static void benchQueueFile(HANDLE hFile, const string& backend, int capacity, long long iterations, vector<BenchResult>& results) {
+    QueueHeader q;
+    readQueueHeader(hFile, q);
+
+    char buffer[MSG_SIZE + 1];
+    MessageMeta meta = { 1, 0, 0 };
+    string message = "benchmark";
+
+    results.push_back(measure("read_header", backend, capacity, sizeof(QueueHeader), iterations,
+        [&](long long) { return readQueueHeader(hFile, q); }));
+    results.push_back(measure("write_header", backend, capacity, sizeof(QueueHeader), iterations,
+        [&](long long) { return writeQueueHeader(hFile, q); }));
+    results.push_back(measure("write_message", backend, capacity, SLOT_SIZE, iterations,
+        [&](long long i) { return writeMessage(hFile, q, (int)(i % capacity), message, meta); }));
+    results.push_back(measure("read_message", backend, capacity, SLOT_SIZE, iterations,
+        [&](long long i) { return readMessage(hFile, q, (int)(i % capacity), buffer, &meta); }));
+
+    for (int blockSize : BENCH_BLOCK_SIZES) {
+        vector<char> block(blockSize, 'x');
+        long long blocks = max(1LL, (long long)capacity * SLOT_SIZE / blockSize);
+
+        results.push_back(measure("write_block", backend, capacity, blockSize, iterations,
+            [&](long long i) { return writeBlock(hFile, slotOffset(q, 0) + (i % blocks) * blockSize, block.data(), blockSize, "Failed to write block."); }));
+        results.push_back(measure("read_block", backend, capacity, blockSize, iterations,
+            [&](long long i) { return readBlock(hFile, slotOffset(q, 0) + (i % blocks) * blockSize, block.data(), blockSize, "Failed to read block."); }));
+    }
+}
+
+static void benchBackends(int capacity, long long iterations, vector<BenchResult>& results) {
+    string filename = "bench_queue_" + to_string(GetTickCount()) + ".bin";
+    HANDLE hFile = openFile(filename, true);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    QueueHeader q;
+    if (initializeQueueFile(hFile, capacity) && readQueueHeader(hFile, q)) {
+        benchQueueFile(hFile, "file", capacity, iterations, results);
+
+        if (mapQueueFile(hFile, wheelSectionEnd(q), NUMA_NO_PREFERRED_NODE)) {
+            benchQueueFile(hFile, "mapped", capacity, iterations, results);
+            unmapQueueFile(hFile);
+        }
+    }
+
+    CloseHandle(hFile);
+    DeleteFileA(filename.c_str());
+}
+
+static void benchSynchronization(long long iterations, vector<BenchResult>& results) {
+    HANDLE hMutex = CreateMutexA(NULL, FALSE, NULL);
+    HANDLE evManual = CreateEventA(NULL, TRUE, TRUE, NULL);
+    HANDLE evPing = CreateEventA(NULL, FALSE, FALSE, NULL);
+    HANDLE evPong = CreateEventA(NULL, FALSE, FALSE, NULL);
+
+    if (!hMutex || !evManual || !evPing || !evPong) {
+        printError("Failed to create benchmark objects");
+        cleanupHandles({ hMutex, evManual, evPing, evPong });
+        return;
+    }
+
+    results.push_back(measure("mutex_acquire_release", "kernel", 0, 0, iterations,
+        [&](long long) { return WaitForSingleObject(hMutex, INFINITE) == WAIT_OBJECT_0 && ReleaseMutex(hMutex); }));
+    results.push_back(measure("event_signal", "kernel", 0, 0, iterations,
+        [&](long long) { return SetEvent(evManual) != FALSE; }));
+    results.push_back(measure("event_wait_signaled", "kernel", 0, 0, iterations,
+        [&](long long) { return WaitForSingleObject(evManual, 0) == WAIT_OBJECT_0; }));
+
+    long long roundTrips = min(iterations, BENCH_ITERATIONS / 10);
+    long long handoffs = roundTrips + min(roundTrips, BENCH_WARMUP);
+    thread echo([&]() {
+        for (long long i = 0; i < handoffs; ++i) {
+            if (WaitForSingleObject(evPing, 5000) != WAIT_OBJECT_0) {
+                break;
+            }
+            SetEvent(evPong);
+        }
+    });
+
+    results.push_back(measure("event_round_trip", "kernel", 0, 0, roundTrips,
+        [&](long long) { return SetEvent(evPing) && WaitForSingleObject(evPong, 5000) == WAIT_OBJECT_0; }));
+
+    echo.join();
+    cleanupHandles({ hMutex, evManual, evPing, evPong });
+}
+
+static void writeJson(ostream& out, const vector<BenchResult>& results) {
+    out << "{\n"
+        << "  \"schema\": 1,\n"
+        << "  \"clock\": \"QueryPerformanceCounter\",\n"
+        << "  \"counters\": {\"cycles\": \"QueryThreadCycleTime\", \"instructions\": null, \"cache_misses\": null, \"context_switches\": null},\n"
+        << "  \"results\": [\n"
+        << fixed << setprecision(1);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        double ops = r.iterations > 0 ? (double)r.iterations : 1.0;
+
+        out << "    {\"primitive\": \"" << r.primitive << "\", \"backend\": \"" << r.backend
+            << "\", \"capacity\": " << r.capacity << ", \"block_size\": " << r.blockSize
+            << ", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << r.nanoseconds / ops
+            << ", \"cycles_per_op\": " << r.cycles / ops
+            << ", \"instructions_per_op\": null, \"cache_misses_per_op\": null, \"context_switches_per_op\": null}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    long long iterations = BENCH_ITERATIONS;
+    string outputFile;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = atoll(argv[++i]);
+        }
+        else if (arg == "--out" && i + 1 < argc) {
+            outputFile = argv[++i];
+        }
+        else {
+            iterations = 0;
+            break;
+        }
+    }
+
+    if (iterations <= 0) {
+        cout << "Usage: OS_LAB_4_bench [--iterations <n>] [--out <file.json>]\n";
+        return 1;
+    }
+
+    vector<BenchResult> results;
+    for (int capacity : BENCH_CAPACITIES) {
+        benchBackends(capacity, iterations, results);
+    }
+    benchSynchronization(iterations, results);
+
+    if (outputFile.empty()) {
+        writeJson(cout, results);
+        return 0;
+    }
+
+    ofstream out(outputFile);
+    if (!out) {
+        cout << "Failed to open " << outputFile << "\n";
+        return 1;
+    }
+    writeJson(out, results);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "broadcast.h"
+
+static LONGLONG broadcastOffset(const QueueHeader& header) {
+    return slotOffset(header, header.capacity);
+}
+
+LONGLONG broadcastSectionEnd(const QueueHeader& header) {
+    return broadcastOffset(header) + sizeof(BroadcastSection);
+}
+
+static void updateReclaimPosition(QueueHeader& header, const BroadcastSection& section) {
+    int slowest = 0;
+    for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+        if (section.subscribers[i].state == SUBSCRIBER_ACTIVE) {
+            slowest = max(slowest, section.subscribers[i].pending);
+        }
+    }
+
+    header.count = slowest;
+    header.head = (header.tail - slowest + header.capacity) % header.capacity;
+}
+
+bool initializeBroadcast(HANDLE hFile, const QueueHeader& header, bool dropLagging) {
+    BroadcastSection section = {};
+    section.magic = BROADCAST_MAGIC;
+    section.dropLagging = dropLagging ? 1 : 0;
+
+    return writeBroadcastSection(hFile, header, section);
+}
+
+bool readBroadcastSection(HANDLE hFile, const QueueHeader& header, BroadcastSection& section) {
+    return readBlock(hFile, broadcastOffset(header), &section, sizeof(section),
+        "Failed to read subscriber table.");
+}
+
+bool writeBroadcastSection(HANDLE hFile, const QueueHeader& header, const BroadcastSection& section) {
+    return writeBlock(hFile, broadcastOffset(header), &section, sizeof(section),
+        "Failed to write subscriber table.");
+}
+
+bool isBroadcastQueue(const BroadcastSection& section) {
+    return section.magic == BROADCAST_MAGIC;
+}
+
+bool subscribe(HANDLE hFile, HANDLE hMutex, int subscriberId) {
+    if (subscriberId < 0 || subscriberId >= MAX_SUBSCRIBERS) {
+        cout << "Subscriber id must be in range [0, " << MAX_SUBSCRIBERS - 1 << "]\n";
+        return false;
+    }
+
+    if (!waitForObject(hMutex, "Waiting for mutex")) {
+        return false;
+    }
+
+    QueueHeader h;
+    BroadcastSection section;
+    bool ok = readQueueHeader(hFile, h) && readBroadcastSection(hFile, h, section);
+
+    if (ok && !isBroadcastQueue(section)) {
+        cout << "Queue is not in broadcast mode\n";
+        ok = false;
+    }
+    else if (ok && section.subscribers[subscriberId].state == SUBSCRIBER_ACTIVE) {
+        cout << "Subscriber #" << subscriberId << " is already connected\n";
+        ok = false;
+    }
+
+    if (ok) {
+        section.subscribers[subscriberId].state = SUBSCRIBER_ACTIVE;
+        section.subscribers[subscriberId].pending = 0;
+        ok = writeBroadcastSection(hFile, h, section);
+    }
+
+    ReleaseMutex(hMutex);
+    return ok;
+}
+
+void unsubscribe(HANDLE hFile, HANDLE hMutex, int subscriberId) {
+    if (!waitForObject(hMutex, "Waiting for mutex")) {
+        return;
+    }
+
+    QueueHeader h;
+    BroadcastSection section;
+    if (readQueueHeader(hFile, h) && readBroadcastSection(hFile, h, section)) {
+        section.subscribers[subscriberId].state = SUBSCRIBER_FREE;
+        section.subscribers[subscriberId].pending = 0;
+        updateReclaimPosition(h, section);
+        writeBroadcastSection(hFile, h, section);
+        writeQueueHeader(hFile, h);
+    }
+
+    ReleaseMutex(hMutex);
+}
+
+bool publishMessage(HANDLE hFile, QueueHeader& header, BroadcastSection& section, const string& message, const MessageMeta& meta) {
+    if (header.count == header.capacity) {
+        if (!section.dropLagging) {
+            return false;
+        }
+
+        for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+            SubscriberSlot& sub = section.subscribers[i];
+            if (sub.state == SUBSCRIBER_ACTIVE && sub.pending == header.capacity) {
+                sub.state = SUBSCRIBER_DROPPED;
+                sub.pending = 0;
+                section.droppedCount++;
+            }
+        }
+    }
+
+    if (!writeMessage(hFile, header, header.tail, message, meta)) {
+        return false;
+    }
+
+    header.tail = (header.tail + 1) % header.capacity;
+    for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+        if (section.subscribers[i].state == SUBSCRIBER_ACTIVE) {
+            section.subscribers[i].pending++;
+        }
+    }
+    updateReclaimPosition(header, section);
+
+    return writeBroadcastSection(hFile, header, section) && writeQueueHeader(hFile, header);
+}
+
+bool receiveBroadcast(HANDLE hFile, QueueHeader& header, BroadcastSection& section, int subscriberId, char* buffer, MessageMeta* meta) {
+    SubscriberSlot& sub = section.subscribers[subscriberId];
+    if (sub.state != SUBSCRIBER_ACTIVE || sub.pending == 0) {
+        return false;
+    }
+
+    int index = (header.tail - sub.pending + header.capacity) % header.capacity;
+    if (!readMessage(hFile, header, index, buffer, meta)) {
+        return false;
+    }
+
+    sub.pending--;
+    updateReclaimPosition(header, section);
+
+    return writeBroadcastSection(hFile, header, section) && writeQueueHeader(hFile, header);
+}
+
+void notifySubscribers(const BroadcastSection& section) {
+    for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+        if (section.subscribers[i].state == SUBSCRIBER_FREE) {
+            continue;
+        }
+
+        HANDLE ev = OpenEventA(EVENT_MODIFY_STATE, FALSE, subscriberEventName(i).c_str());
+        if (ev) {
+            SetEvent(ev);
+            CloseHandle(ev);
+        }
+    }
+}
+
+string subscriberEventName(int subscriberId) {
+    return queueObjectName("SubscriberNotEmpty_" + to_string(subscriberId));
+}
\ No newline at end of file
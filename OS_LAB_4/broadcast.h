@@ -0,0 +1,50 @@
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include "queue_file.h"
+#include "sync_utils.h"
+
+using namespace std;
+
+const int MAX_SUBSCRIBERS = 16;
+const int BROADCAST_MAGIC = 0x54534342;
+
+enum SubscriberState {
+    SUBSCRIBER_FREE = 0,
+    SUBSCRIBER_ACTIVE = 1,
+    SUBSCRIBER_DROPPED = 2
+};
+
+#pragma pack(push,1)
+struct SubscriberSlot {
+    int state;
+    int pending;
+};
+
+struct BroadcastSection {
+    int magic;
+    int dropLagging;
+    int droppedCount;
+    SubscriberSlot subscribers[MAX_SUBSCRIBERS];
+};
+#pragma pack(pop)
+
+LONGLONG broadcastSectionEnd(const QueueHeader& header);
+bool initializeBroadcast(HANDLE hFile, const QueueHeader& header, bool dropLagging);
+bool readBroadcastSection(HANDLE hFile, const QueueHeader& header, BroadcastSection& section);
+bool writeBroadcastSection(HANDLE hFile, const QueueHeader& header, const BroadcastSection& section);
+bool isBroadcastQueue(const BroadcastSection& section);
+
+bool subscribe(HANDLE hFile, HANDLE hMutex, int subscriberId);
+void unsubscribe(HANDLE hFile, HANDLE hMutex, int subscriberId);
+
+bool publishMessage(HANDLE hFile, QueueHeader& header, BroadcastSection& section, const string& message, const MessageMeta& meta = MessageMeta());
+bool receiveBroadcast(HANDLE hFile, QueueHeader& header, BroadcastSection& section, int subscriberId, char* buffer, MessageMeta* meta = NULL);
+void notifySubscribers(const BroadcastSection& section);
+
+string subscriberEventName(int subscriberId);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "drain.h"
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+struct StagingBuffer {
+    mutex lock;
+    condition_variable ready;
+    condition_variable space;
+    vector<string> messages;
+    size_t bytes = 0;
+    bool finished = false;
+};
+
+static void dequeueStage(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, long long maxMessages,
+    DWORD idleTimeout, size_t stagingLimit, StagingBuffer& staging, DrainStats& stats) {
+    vector<string> batch;
+
+    while (maxMessages <= 0 || stats.messages < maxMessages) {
+        {
+            unique_lock<mutex> guard(staging.lock);
+            staging.space.wait(guard, [&] { return staging.bytes < stagingLimit; });
+        }
+
+        int limit = maxMessages <= 0 ? MAX_BATCH : (int)min(maxMessages - stats.messages, (long long)MAX_BATCH);
+
+        batch.clear();
+        int taken = dequeueBatch(hFile, hMutex, evNotEmpty, evNotFull, limit, batch, NULL, idleTimeout);
+        if (taken == 0) {
+            break;
+        }
+
+        stats.messages += taken;
+        stats.batches++;
+
+        lock_guard<mutex> guard(staging.lock);
+        for (string& message : batch) {
+            staging.bytes += message.size() + 1;
+            staging.messages.push_back(move(message));
+        }
+        stats.peakStaged = max(stats.peakStaged, staging.bytes);
+        staging.ready.notify_one();
+    }
+
+    lock_guard<mutex> guard(staging.lock);
+    staging.finished = true;
+    staging.ready.notify_one();
+}
+
+static void writeChunk(ostream& out, string& chunk, DrainStats& stats) {
+    if (!chunk.empty()) {
+        out.write(chunk.data(), chunk.size());
+        chunk.clear();
+        stats.writes++;
+    }
+}
+
+DrainStats drainQueue(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, ostream& out,
+    long long maxMessages, DWORD idleTimeout, size_t stagingLimit) {
+    DrainStats stats = { 0, 0, 0, 0 };
+    StagingBuffer staging;
+    thread dequeuer(dequeueStage, hFile, hMutex, evNotEmpty, evNotFull, maxMessages, idleTimeout, stagingLimit, ref(staging), ref(stats));
+
+    string chunk;
+    vector<string> ready;
+
+    while (true) {
+        {
+            unique_lock<mutex> guard(staging.lock);
+            if (staging.messages.empty() && !staging.finished) {
+                guard.unlock();
+                writeChunk(out, chunk, stats);
+                guard.lock();
+            }
+
+            staging.ready.wait(guard, [&] { return !staging.messages.empty() || staging.finished; });
+            ready.swap(staging.messages);
+            staging.bytes = 0;
+            staging.space.notify_one();
+            if (ready.empty()) {
+                break;
+            }
+        }
+
+        for (const string& message : ready) {
+            chunk += message;
+            chunk += '\n';
+        }
+        ready.clear();
+
+        if (chunk.size() >= DRAIN_CHUNK) {
+            writeChunk(out, chunk, stats);
+        }
+    }
+
+    dequeuer.join();
+    writeChunk(out, chunk, stats);
+    out.flush();
+    return stats;
+}
+
+bool parseDrainArgs(const string& args, long long& maxMessages, string& outputFile) {
+    istringstream in(args);
+    string token;
+    maxMessages = 0;
+    outputFile.clear();
+
+    while (in >> token) {
+        if (token == "--out") {
+            if (!(in >> outputFile)) {
+                return false;
+            }
+        }
+        else {
+            istringstream number(token);
+            if (!(number >> maxMessages) || maxMessages < 0 || !number.eof()) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void processDrainCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, long long maxMessages, const string& outputFile) {
+    ofstream file;
+    vector<char> fileBuffer(DRAIN_CHUNK);
+
+    if (!outputFile.empty()) {
+        file.rdbuf()->pubsetbuf(fileBuffer.data(), fileBuffer.size());
+        file.open(outputFile, ios::binary | ios::app);
+        if (!file) {
+            cout << "Failed to open " << outputFile << "\n";
+            return;
+        }
+    }
+
+    LARGE_INTEGER frequency, start, finish;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+
+    DrainStats stats = drainQueue(hFile, hMutex, evNotEmpty, evNotFull, outputFile.empty() ? cout : file, maxMessages);
+
+    QueryPerformanceCounter(&finish);
+    double seconds = double(finish.QuadPart - start.QuadPart) / frequency.QuadPart;
+
+    cout << "Drained " << stats.messages << " messages in " << stats.batches << " batches, "
+        << stats.writes << " writes, " << seconds << " s\n";
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef DRAIN_H
+#define DRAIN_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "batch_io.h"
+
+using namespace std;
+
+const size_t DRAIN_CHUNK = 64 * 1024;
+const size_t DRAIN_STAGING_LIMIT = 4 * DRAIN_CHUNK;
+const DWORD DRAIN_IDLE_TIMEOUT = 1000;
+
+struct DrainStats {
+    long long messages;
+    long long batches;
+    long long writes;
+    size_t peakStaged;
+};
+
+DrainStats drainQueue(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, ostream& out,
+    long long maxMessages, DWORD idleTimeout = DRAIN_IDLE_TIMEOUT, size_t stagingLimit = DRAIN_STAGING_LIMIT);
+bool parseDrainArgs(const string& args, long long& maxMessages, string& outputFile);
+void processDrainCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, long long maxMessages, const string& outputFile);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,344 @@
+#include "message_index.h"
+#include "broadcast.h"
+#include "transaction.h"
+#include <map>
+#include <sstream>
+
+static LONGLONG indexOffset(const QueueHeader& header) {
+    return broadcastSectionEnd(header);
+}
+
+LONGLONG indexSectionEnd(const QueueHeader& header) {
+    return indexOffset(header) + sizeof(MessageIndex);
+}
+
+bool readMessageIndex(HANDLE hFile, const QueueHeader& header, MessageIndex& index) {
+    return readBlock(hFile, indexOffset(header), &index, sizeof(index), "Failed to read message index.");
+}
+
+bool writeMessageIndex(HANDLE hFile, const QueueHeader& header, const MessageIndex& index) {
+    return writeBlock(hFile, indexOffset(header), &index, sizeof(index), "Failed to write message index.");
+}
+
+static bool isIndexedSender(int senderId) {
+    return senderId >= 0 && senderId < MAX_INDEXED_SENDERS;
+}
+
+static bool isIndexedTag(int tag) {
+    return tag >= 0 && tag < MAX_TAGS;
+}
+
+bool isValidFilter(const MessageFilter& filter) {
+    switch (filter.kind) {
+    case MATCH_ANY:
+        return true;
+    case MATCH_SENDER:
+        return isIndexedSender(filter.value);
+    case MATCH_TAG:
+        return isIndexedTag(filter.value);
+    default:
+        return false;
+    }
+}
+
+bool parseFilter(const string& args, MessageFilter& filter) {
+    istringstream in(args);
+    string option;
+    filter = { MATCH_ANY, 0 };
+
+    if (!(in >> option)) {
+        return true;
+    }
+
+    if (option == "--from") {
+        filter.kind = MATCH_SENDER;
+    }
+    else if (option == "--tag") {
+        filter.kind = MATCH_TAG;
+    }
+    else {
+        return false;
+    }
+
+    return (in >> filter.value) && isValidFilter(filter);
+}
+
+static LONGLONG linkOffset(const QueueHeader& header, int slot, bool bySender) {
+    return slotOffset(header, slot) + (bySender ? offsetof(SlotHeader, nextFromSender) : offsetof(SlotHeader, nextWithTag));
+}
+
+static char* batchLink(const QueueHeader& header, int slot, bool bySender, char* batch, int batchFirst, int batchCount) {
+    int pos = (slot - batchFirst + header.capacity) % header.capacity;
+    if (!batch || pos >= batchCount) {
+        return NULL;
+    }
+    return batch + pos * SLOT_SIZE + (bySender ? offsetof(SlotHeader, nextFromSender) : offsetof(SlotHeader, nextWithTag));
+}
+
+static bool readLink(HANDLE hFile, const QueueHeader& header, int slot, bool bySender, int& link,
+    char* batch, int batchFirst, int batchCount) {
+    char* cached = batchLink(header, slot, bySender, batch, batchFirst, batchCount);
+    if (cached) {
+        memcpy(&link, cached, sizeof(link));
+        return true;
+    }
+    return readBlock(hFile, linkOffset(header, slot, bySender), &link, sizeof(link), "Failed to read index link.");
+}
+
+static bool writeLink(HANDLE hFile, const QueueHeader& header, int slot, bool bySender, int link,
+    char* batch, int batchFirst, int batchCount) {
+    char* cached = batchLink(header, slot, bySender, batch, batchFirst, batchCount);
+    if (cached) {
+        memcpy(cached, &link, sizeof(link));
+        return true;
+    }
+    return writeBlock(hFile, linkOffset(header, slot, bySender), &link, sizeof(link), "Failed to write index link.");
+}
+
+static int ringDistance(const QueueHeader& header, int slot) {
+    return (slot - header.head + header.capacity) % header.capacity;
+}
+
+static bool appendToList(HANDLE hFile, const QueueHeader& header, IndexList& list, int slot, bool bySender,
+    char* batch = NULL, int batchFirst = 0, int batchCount = 0) {
+    int link = slot + 1;
+
+    if (list.last == 0) {
+        list.first = link;
+    }
+    else if (!writeLink(hFile, header, list.last - 1, bySender, link, batch, batchFirst, batchCount)) {
+        return false;
+    }
+
+    list.last = link;
+    return true;
+}
+
+static bool insertIntoList(HANDLE hFile, const QueueHeader& header, IndexList& list, int slot, bool bySender,
+    char* batch, int batchFirst, int batchCount) {
+    int distance = ringDistance(header, slot);
+    if (list.last == 0 || ringDistance(header, list.last - 1) < distance) {
+        return appendToList(hFile, header, list, slot, bySender, batch, batchFirst, batchCount);
+    }
+
+    int prev = 0;
+    int next = list.first;
+    while (ringDistance(header, next - 1) < distance) {
+        prev = next;
+        if (!readLink(hFile, header, prev - 1, bySender, next, batch, batchFirst, batchCount)) {
+            return false;
+        }
+    }
+
+    if (!writeLink(hFile, header, slot, bySender, next, batch, batchFirst, batchCount)) {
+        return false;
+    }
+
+    if (prev == 0) {
+        list.first = slot + 1;
+        return true;
+    }
+    return writeLink(hFile, header, prev - 1, bySender, slot + 1, batch, batchFirst, batchCount);
+}
+
+static void popFront(IndexList& list, int next) {
+    list.first = next;
+    if (next == 0) {
+        list.last = 0;
+    }
+}
+
+static void unlinkHead(MessageIndex& index, int slot, const SlotHeader& sh) {
+    int senderId = sh.meta.senderId;
+    if (isIndexedSender(senderId) && index.bySender[senderId].first == slot + 1) {
+        popFront(index.bySender[senderId], sh.nextFromSender);
+    }
+
+    int tag = sh.meta.tag;
+    if (isIndexedTag(tag) && index.byTag[tag].first == slot + 1) {
+        popFront(index.byTag[tag], sh.nextWithTag);
+    }
+}
+
+void releaseHeadSlot(QueueHeader& header, MessageIndex& index, const SlotHeader& sh) {
+    unlinkHead(index, header.head, sh);
+
+    if (sh.state == SLOT_CONSUMED) {
+        index.holes--;
+    }
+    else {
+        index.live--;
+    }
+
+    header.head = (header.head + 1) % header.capacity;
+    header.count--;
+}
+
+bool skipConsumedAtHead(HANDLE hFile, QueueHeader& header, MessageIndex& index) {
+    char buffer[MSG_SIZE + 1];
+
+    while (index.holes > 0 && header.count > 0) {
+        SlotHeader sh;
+        if (!readSlot(hFile, header, header.head, sh, buffer)) {
+            return false;
+        }
+
+        if (sh.state != SLOT_CONSUMED) {
+            break;
+        }
+
+        releaseHeadSlot(header, index, sh);
+    }
+
+    return true;
+}
+
+bool appendToIndex(HANDLE hFile, const QueueHeader& header, MessageIndex& index, int slot, const MessageMeta& meta) {
+    index.live++;
+
+    if (isIndexedSender(meta.senderId) &&
+        !appendToList(hFile, header, index.bySender[meta.senderId], slot, true)) {
+        return false;
+    }
+
+    if (isIndexedTag(meta.tag) &&
+        !appendToList(hFile, header, index.byTag[meta.tag], slot, false)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool appendBatchToIndex(HANDLE hFile, const QueueHeader& header, MessageIndex& index, int firstSlot, int count, char* slots) {
+    for (int i = 0; i < count; ++i) {
+        SlotHeader sh;
+        memcpy(&sh, slots + i * SLOT_SIZE, sizeof(sh));
+        int slot = (firstSlot + i) % header.capacity;
+        index.live++;
+
+        if (isIndexedSender(sh.meta.senderId) &&
+            !insertIntoList(hFile, header, index.bySender[sh.meta.senderId], slot, true, slots, firstSlot, count)) {
+            return false;
+        }
+
+        if (isIndexedTag(sh.meta.tag) &&
+            !insertIntoList(hFile, header, index.byTag[sh.meta.tag], slot, false, slots, firstSlot, count)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TakeResult takeMessage(HANDLE hFile, QueueHeader& header, MessageIndex& index, const MessageFilter& filter, char* buffer, MessageMeta* meta) {
+    SlotHeader sh;
+    int slot;
+    IndexList* list = NULL;
+
+    if (filter.kind == MATCH_ANY) {
+        while (true) {
+            if (header.count == 0) {
+                return TAKE_EMPTY;
+            }
+
+            slot = header.head;
+            if (!readSlot(hFile, header, slot, sh, buffer)) {
+                return TAKE_ERROR;
+            }
+
+            if (sh.state == SLOT_READY) {
+                break;
+            }
+
+            if (sh.state == SLOT_CONSUMED) {
+                releaseHeadSlot(header, index, sh);
+                continue;
+            }
+
+            TakeResult released = releaseAbandonedTransaction(hFile, header, index, slot);
+            if (released != TAKE_OK) {
+                return released == TAKE_EMPTY ? TAKE_BLOCKED : released;
+            }
+        }
+    }
+    else {
+        bool bySender = filter.kind == MATCH_SENDER;
+        list = bySender ? &index.bySender[filter.value] : &index.byTag[filter.value];
+
+        while (true) {
+            if (list->first == 0) {
+                return TAKE_EMPTY;
+            }
+
+            slot = list->first - 1;
+            if (!readSlot(hFile, header, slot, sh, buffer)) {
+                return TAKE_ERROR;
+            }
+
+            if (sh.state == SLOT_READY) {
+                break;
+            }
+
+            popFront(*list, bySender ? sh.nextFromSender : sh.nextWithTag);
+        }
+    }
+
+    if (meta) {
+        *meta = sh.meta;
+    }
+
+    if (slot == header.head) {
+        releaseHeadSlot(header, index, sh);
+        return skipConsumedAtHead(hFile, header, index) ? TAKE_OK : TAKE_ERROR;
+    }
+
+    if (!writeSlotState(hFile, header, slot, SLOT_CONSUMED)) {
+        return TAKE_ERROR;
+    }
+
+    index.live--;
+    index.holes++;
+    popFront(*list, filter.kind == MATCH_SENDER ? sh.nextFromSender : sh.nextWithTag);
+    return TAKE_OK;
+}
+
+static map<string, HANDLE> filterEvents;
+
+HANDLE filterEvent(const MessageFilter& filter) {
+    string name = filter.kind == MATCH_SENDER ? "QueueFromSender_" : "QueueWithTag_";
+    name = queueObjectName(name + to_string(filter.value));
+
+    auto it = filterEvents.find(name);
+    if (it != filterEvents.end()) {
+        return it->second;
+    }
+
+    HANDLE ev = createEvent(name, false);
+    if (ev) {
+        filterEvents[name] = ev;
+    }
+    return ev;
+}
+
+void closeFilterEvents() {
+    for (auto& entry : filterEvents) {
+        CloseHandle(entry.second);
+    }
+    filterEvents.clear();
+}
+
+void notifyFilterEvents(const MessageMeta& meta) {
+    if (isIndexedSender(meta.senderId)) {
+        HANDLE ev = filterEvent({ MATCH_SENDER, meta.senderId });
+        if (ev) {
+            SetEvent(ev);
+        }
+    }
+
+    if (isIndexedTag(meta.tag)) {
+        HANDLE ev = filterEvent({ MATCH_TAG, meta.tag });
+        if (ev) {
+            SetEvent(ev);
+        }
+    }
+}
\ No newline at end of file
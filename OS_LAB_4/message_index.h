@@ -0,0 +1,63 @@
+#ifndef MESSAGE_INDEX_H
+#define MESSAGE_INDEX_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include "queue_file.h"
+#include "sync_utils.h"
+
+using namespace std;
+
+const int MAX_INDEXED_SENDERS = 32;
+const int MAX_TAGS = 16;
+
+#pragma pack(push,1)
+struct IndexList {
+    int first;
+    int last;
+};
+
+struct MessageIndex {
+    int live;
+    int holes;
+    IndexList bySender[MAX_INDEXED_SENDERS];
+    IndexList byTag[MAX_TAGS];
+};
+#pragma pack(pop)
+
+enum MatchKind {
+    MATCH_ANY = 0,
+    MATCH_SENDER = 1,
+    MATCH_TAG = 2
+};
+
+struct MessageFilter {
+    int kind;
+    int value;
+};
+
+enum TakeResult {
+    TAKE_OK,
+    TAKE_EMPTY,
+    TAKE_BLOCKED,
+    TAKE_ERROR
+};
+
+LONGLONG indexSectionEnd(const QueueHeader& header);
+bool readMessageIndex(HANDLE hFile, const QueueHeader& header, MessageIndex& index);
+bool writeMessageIndex(HANDLE hFile, const QueueHeader& header, const MessageIndex& index);
+
+bool isValidFilter(const MessageFilter& filter);
+bool parseFilter(const string& args, MessageFilter& filter);
+bool appendToIndex(HANDLE hFile, const QueueHeader& header, MessageIndex& index, int slot, const MessageMeta& meta);
+bool appendBatchToIndex(HANDLE hFile, const QueueHeader& header, MessageIndex& index, int firstSlot, int count, char* slots);
+void releaseHeadSlot(QueueHeader& header, MessageIndex& index, const SlotHeader& sh);
+bool skipConsumedAtHead(HANDLE hFile, QueueHeader& header, MessageIndex& index);
+TakeResult takeMessage(HANDLE hFile, QueueHeader& header, MessageIndex& index, const MessageFilter& filter, char* buffer, MessageMeta* meta);
+
+HANDLE filterEvent(const MessageFilter& filter);
+void notifyFilterEvents(const MessageMeta& meta);
+void closeFilterEvents();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "overflow.h"
+#include <sstream>
+
+bool parseOverflowPolicy(const string& spec, int& policy, int& blockTimeout) {
+    blockTimeout = 0;
+
+    if (spec == "drop-oldest") {
+        policy = OVERFLOW_DROP_OLDEST;
+        return true;
+    }
+    if (spec == "drop-newest") {
+        policy = OVERFLOW_DROP_NEWEST;
+        return true;
+    }
+    if (spec == "fail") {
+        policy = OVERFLOW_FAIL;
+        return true;
+    }
+
+    policy = OVERFLOW_BLOCK;
+    if (spec == "block") {
+        return true;
+    }
+
+    if (spec.compare(0, 6, "block:") == 0) {
+        istringstream in(spec.substr(6));
+        return (in >> blockTimeout) && in.eof() && blockTimeout > 0;
+    }
+
+    return false;
+}
+
+string overflowPolicyName(int policy) {
+    switch (policy) {
+    case OVERFLOW_BLOCK:
+        return "block";
+    case OVERFLOW_DROP_OLDEST:
+        return "drop-oldest";
+    case OVERFLOW_DROP_NEWEST:
+        return "drop-newest";
+    case OVERFLOW_FAIL:
+        return "fail";
+    default:
+        return "unknown";
+    }
+}
+
+static bool recordTimeout(HANDLE hFile, HANDLE hMutex) {
+    if (!waitForObject(hMutex, "Waiting for mutex")) {
+        return false;
+    }
+
+    QueueHeader q;
+    bool ok = readQueueHeader(hFile, q);
+    if (ok) {
+        q.timedOut++;
+        ok = writeQueueHeader(hFile, q);
+    }
+
+    ReleaseMutex(hMutex);
+    return ok;
+}
+
+bool waitForSpace(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, const QueueHeader& header, DWORD started, DWORD timeout) {
+    DWORD deadline = header.blockTimeout > 0 ? header.blockTimeout : timeout;
+    DWORD elapsed = GetTickCount() - started;
+    DWORD remaining = elapsed < deadline ? deadline - elapsed : 0;
+
+    if (waitForObject(evNotFull, "Waiting for space in queue", remaining)) {
+        return true;
+    }
+
+    recordTimeout(hFile, hMutex);
+    return false;
+}
+
+bool rejectMessage(HANDLE hFile, QueueHeader& header) {
+    bool dropped = header.overflowPolicy == OVERFLOW_DROP_NEWEST;
+
+    if (dropped) {
+        header.droppedNewest++;
+    }
+    else {
+        header.rejected++;
+        cout << "Queue is full, message rejected\n";
+    }
+
+    return writeQueueHeader(hFile, header) && dropped;
+}
+
+TakeResult dropOldestMessage(HANDLE hFile, QueueHeader& header, MessageIndex& index) {
+    char buffer[MSG_SIZE + 1];
+
+    TakeResult result = takeMessage(hFile, header, index, { MATCH_ANY, 0 }, buffer, NULL);
+    if (result == TAKE_OK) {
+        header.droppedOldest++;
+    }
+    return result;
+}
+
+void printQueueStats(const QueueHeader& header) {
+    cout << "Queue: " << header.count << "/" << header.capacity
+        << ", overflow policy: " << overflowPolicyName(header.overflowPolicy);
+    if (header.overflowPolicy == OVERFLOW_BLOCK && header.blockTimeout > 0) {
+        cout << " (" << header.blockTimeout << " ms)";
+    }
+    cout << "\n"
+        << "  timed out: " << header.timedOut << "\n"
+        << "  dropped oldest: " << header.droppedOldest << "\n"
+        << "  dropped newest: " << header.droppedNewest << "\n"
+        << "  rejected: " << header.rejected << "\n";
+}
+
+void processStatsCommand(HANDLE hFile, HANDLE hMutex) {
+    if (!waitForObject(hMutex, "Waiting for mutex")) {
+        return;
+    }
+
+    QueueHeader q;
+    bool ok = readQueueHeader(hFile, q);
+    ReleaseMutex(hMutex);
+
+    if (ok) {
+        printQueueStats(q);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#ifndef OVERFLOW_H
+#define OVERFLOW_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "message_index.h"
+
+using namespace std;
+
+bool parseOverflowPolicy(const string& spec, int& policy, int& blockTimeout);
+string overflowPolicyName(int policy);
+
+bool waitForSpace(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, const QueueHeader& header, DWORD started, DWORD timeout);
+bool rejectMessage(HANDLE hFile, QueueHeader& header);
+TakeResult dropOldestMessage(HANDLE hFile, QueueHeader& header, MessageIndex& index);
+
+void printQueueStats(const QueueHeader& header);
+void processStatsCommand(HANDLE hFile, HANDLE hMutex);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "pingpong.h"
+#include "receiver.h"
+#include "queue_registry.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+static double elapsedMicroseconds(const LARGE_INTEGER& start, const LARGE_INTEGER& end, const LARGE_INTEGER& freq) {
+    return (end.QuadPart - start.QuadPart) * 1000000.0 / freq.QuadPart;
+}
+
+static void printLatencyStats(vector<double>& samples) {
+    sort(samples.begin(), samples.end());
+
+    double total = 0;
+    for (double s : samples) {
+        total += s;
+    }
+
+    size_t n = samples.size();
+    cout << "Round trips: " << n << "\n"
+        << "  min: " << samples[0] << " us\n"
+        << "  avg: " << total / n << " us\n"
+        << "  p50: " << samples[n / 2] << " us\n"
+        << "  p99: " << samples[min(n - 1, n * 99 / 100)] << " us\n"
+        << "  max: " << samples[n - 1] << " us\n";
+}
+
+bool parsePingPongCount(const string& arg, int& iterations) {
+    istringstream in(arg);
+    return (in >> iterations) && in.eof() && iterations > 0;
+}
+
+void runEchoServer(const string& filename) {
+    HANDLE hFile = openFile(filename);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    HANDLE hMutex = openMutex(queueObjectName("QueueMutex"));
+    HANDLE evNotEmpty = openEvent(queueObjectName("QueueNotEmpty"));
+    HANDLE evNotFull = openEvent(queueObjectName("QueueNotFull"));
+
+    if (hMutex && evNotEmpty && evNotFull) {
+        map<int, ReplyChannel> channels;
+        serveRequests(hFile, hMutex, evNotEmpty, evNotFull, filename, channels, 0);
+
+        for (auto& entry : channels) {
+            closeReplyChannel(entry.second);
+        }
+    }
+
+    cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+    closeFilterEvents();
+}
+
+void runPingPongBenchmark(const string& filename, int iterations, const LaunchOptions& options) {
+    if (!applyPlacement(GetCurrentProcess(), senderPlacement(options, 0), "benchmark client")) {
+        return;
+    }
+
+    if (!registerQueue(queueNamespace(), filename)) {
+        return;
+    }
+
+    HANDLE hFile = openFile(filename, true);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        unregisterQueue(queueNamespace());
+        return;
+    }
+
+    if (!initializeQueueFile(hFile, PINGPONG_CAPACITY, options.overflowPolicy, options.blockTimeout)) {
+        CloseHandle(hFile);
+        unregisterQueue(queueNamespace());
+        return;
+    }
+
+    HANDLE hMutex = createMutex(queueObjectName("QueueMutex"));
+    HANDLE evNotEmpty = createEvent(queueObjectName("QueueNotEmpty"), false);
+    HANDLE evNotFull = createEvent(queueObjectName("QueueNotFull"), true);
+
+    ReplyChannel channel;
+    if (!hMutex || !evNotEmpty || !evNotFull || !createReplyChannel(filename, 0, channel)) {
+        cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+        unregisterQueue(queueNamespace());
+        return;
+    }
+
+    vector<ChildProcess> processes(1);
+    bool pinServer = isPinned(options.receiver);
+    if (!startSelfProcess("echo " + filename, pinServer ? CREATE_SUSPENDED : 0, processes[0].pi, "echo server")) {
+        closeReplyChannel(channel);
+        cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+        unregisterQueue(queueNamespace());
+        return;
+    }
+
+    if (pinServer) {
+        applyPlacement(processes[0].pi.hProcess, options.receiver, "echo server");
+        ResumeThread(processes[0].pi.hThread);
+    }
+
+    char reply[MSG_SIZE + 1];
+    int correlationId = 1;
+    bool ok = true;
+
+    for (int i = 0; i < PINGPONG_WARMUP && ok; ++i) {
+        ok = callRequest(hFile, hMutex, evNotFull, evNotEmpty, channel, { 0, correlationId++, 0 }, "ping", reply, 10000);
+    }
+
+    LARGE_INTEGER freq, start, end;
+    QueryPerformanceFrequency(&freq);
+
+    vector<double> samples;
+    samples.reserve(iterations);
+    for (int i = 0; i < iterations && ok; ++i) {
+        QueryPerformanceCounter(&start);
+        ok = callRequest(hFile, hMutex, evNotFull, evNotEmpty, channel, { 0, correlationId++, 0 }, "ping", reply);
+        QueryPerformanceCounter(&end);
+
+        if (ok) {
+            samples.push_back(elapsedMicroseconds(start, end, freq));
+        }
+    }
+
+    if (!samples.empty()) {
+        printLatencyStats(samples);
+    }
+    else {
+        cout << "Ping-pong benchmark failed: echo server did not reply\n";
+    }
+
+    terminateAllSenders(processes);
+    closeReplyChannel(channel);
+    cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+    closeFilterEvents();
+    unregisterQueue(queueNamespace());
+}
\ No newline at end of file
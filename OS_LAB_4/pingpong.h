@@ -0,0 +1,21 @@
+#ifndef PINGPONG_H
+#define PINGPONG_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "reply_channel.h"
+#include "placement.h"
+
+using namespace std;
+
+const int PINGPONG_CAPACITY = 16;
+const int PINGPONG_WARMUP = 100;
+
+bool parsePingPongCount(const string& arg, int& iterations);
+void runPingPongBenchmark(const string& filename, int iterations, const LaunchOptions& options = LaunchOptions());
+void runEchoServer(const string& filename);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "placement.h"
+#include "message_index.h"
+#include "overflow.h"
+#include "timing_wheel.h"
+#include <sstream>
+
+static bool parseCpuList(const string& list, DWORD_PTR& mask) {
+    istringstream in(list);
+    string range;
+    const int maxCpu = sizeof(DWORD_PTR) * 8 - 1;
+    mask = 0;
+
+    while (getline(in, range, ',')) {
+        int from, to;
+        char dash;
+        istringstream bounds(range);
+
+        if (!(bounds >> from)) {
+            return false;
+        }
+        to = from;
+        if (bounds >> dash && (dash != '-' || !(bounds >> to))) {
+            return false;
+        }
+        if (!bounds.eof() || from < 0 || to < from || to > maxCpu) {
+            return false;
+        }
+
+        for (int cpu = from; cpu <= to; ++cpu) {
+            mask |= (DWORD_PTR)1 << cpu;
+        }
+    }
+
+    return mask != 0;
+}
+
+bool parsePlacement(const string& spec, Placement& placement) {
+    placement = { ANY_NODE, 0 };
+
+    if (spec == "any") {
+        return true;
+    }
+
+    if (spec.compare(0, 5, "node:") == 0) {
+        istringstream in(spec.substr(5));
+        return (in >> placement.node) && in.eof() && placement.node >= 0;
+    }
+
+    if (spec.compare(0, 4, "cpu:") == 0) {
+        return parseCpuList(spec.substr(4), placement.cpuMask);
+    }
+
+    return false;
+}
+
+bool parseLaunchOptions(int argc, char* argv[], int first, LaunchOptions& options) {
+    options = LaunchOptions();
+
+    for (int i = first; i < argc; i += 2) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+
+        if (option == "--pin-receiver") {
+            if (!parsePlacement(argv[i + 1], options.receiver)) {
+                return false;
+            }
+        }
+        else if (option == "--pin-senders") {
+            istringstream in(argv[i + 1]);
+            string spec;
+            options.senders.clear();
+
+            while (getline(in, spec, '/')) {
+                Placement placement;
+                if (!parsePlacement(spec, placement)) {
+                    return false;
+                }
+                options.senders.push_back(placement);
+            }
+
+            if (options.senders.empty()) {
+                return false;
+            }
+        }
+        else if (option == "--queue") {
+            options.queueName = argv[i + 1];
+            if (!isValidQueueName(options.queueName)) {
+                return false;
+            }
+        }
+        else if (option == "--overflow") {
+            if (!parseOverflowPolicy(argv[i + 1], options.overflowPolicy, options.blockTimeout)) {
+                return false;
+            }
+        }
+        else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool isPinned(const Placement& placement) {
+    return placement.node != ANY_NODE || placement.cpuMask != 0;
+}
+
+bool hasPinnedSenders(const LaunchOptions& options) {
+    for (const Placement& placement : options.senders) {
+        if (isPinned(placement)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const Placement& senderPlacement(const LaunchOptions& options, int senderId) {
+    static const Placement unpinned = { ANY_NODE, 0 };
+    if (options.senders.empty()) {
+        return unpinned;
+    }
+    return options.senders[senderId % options.senders.size()];
+}
+
+DWORD_PTR placementMask(const Placement& placement) {
+    if (placement.cpuMask != 0) {
+        return placement.cpuMask;
+    }
+
+    GROUP_AFFINITY affinity = {};
+    if (placement.node == ANY_NODE || !GetNumaNodeProcessorMaskEx((USHORT)placement.node, &affinity)) {
+        cout << "No processors on NUMA node " << placement.node << "\n";
+        return 0;
+    }
+    if (affinity.Group != 0) {
+        cout << "NUMA node " << placement.node << " is in processor group " << affinity.Group
+            << ", only nodes of group 0 can be pinned\n";
+        return 0;
+    }
+    return affinity.Mask;
+}
+
+bool applyPlacement(HANDLE hProcess, const Placement& placement, const string& description) {
+    if (!isPinned(placement)) {
+        return true;
+    }
+
+    DWORD_PTR mask = placementMask(placement);
+    if (mask == 0) {
+        cout << "Cannot pin " << description << "\n";
+        return false;
+    }
+
+    if (!SetProcessAffinityMask(hProcess, mask)) {
+        printError("Failed to pin " + description);
+        return false;
+    }
+
+    cout << "Pinned " << description << " to CPU mask 0x" << hex << mask << dec << "\n";
+    return true;
+}
+
+void resumePinnedProcesses(vector<ChildProcess>& processes, const LaunchOptions& options) {
+    for (auto& process : processes) {
+        applyPlacement(process.pi.hProcess, senderPlacement(options, process.id), "sender #" + to_string(process.id));
+        ResumeThread(process.pi.hThread);
+    }
+}
+
+DWORD currentNumaNode() {
+    PROCESSOR_NUMBER processor;
+    USHORT node;
+
+    GetCurrentProcessorNumberEx(&processor);
+    if (!GetNumaProcessorNodeEx(&processor, &node)) {
+        return NUMA_NO_PREFERRED_NODE;
+    }
+    return node;
+}
+
+bool mapQueueOnNode(HANDLE hFile, const QueueHeader& header, const Placement& consumer) {
+    DWORD node = consumer.node != ANY_NODE ? (DWORD)consumer.node : currentNumaNode();
+
+    if (!mapQueueFile(hFile, wheelSectionEnd(header), node)) {
+        return false;
+    }
+
+    cout << "Queue file mapped on NUMA node " << (int)node << "\n";
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "queue_file.h"
+#include "sync_utils.h"
+
+using namespace std;
+
+const int ANY_NODE = -1;
+
+struct Placement {
+    int node;
+    DWORD_PTR cpuMask;
+};
+
+struct LaunchOptions {
+    Placement receiver = { ANY_NODE, 0 };
+    vector<Placement> senders;
+    int overflowPolicy = OVERFLOW_BLOCK;
+    int blockTimeout = 0;
+    string queueName;
+};
+
+bool parsePlacement(const string& spec, Placement& placement);
+bool parseLaunchOptions(int argc, char* argv[], int first, LaunchOptions& options);
+bool isPinned(const Placement& placement);
+bool hasPinnedSenders(const LaunchOptions& options);
+const Placement& senderPlacement(const LaunchOptions& options, int senderId);
+
+DWORD_PTR placementMask(const Placement& placement);
+bool applyPlacement(HANDLE hProcess, const Placement& placement, const string& description);
+void resumePinnedProcesses(vector<ChildProcess>& processes, const LaunchOptions& options);
+DWORD currentNumaNode();
+bool mapQueueOnNode(HANDLE hFile, const QueueHeader& header, const Placement& consumer);
+
+#endif
\ No newline at end of file
@@ -1,4 +1,24 @@
 #include "queue_file.h"
+#include <map>
+
+struct MappedView {
+    HANDLE hMapping;
+    char* data;
+    LONGLONG size;
+};
+
+static map<HANDLE, MappedView>& mappedViews() {
+    static map<HANDLE, MappedView> views;
+    return views;
+}
+
+static char* mappedBlock(HANDLE hFile, LONGLONG offset, DWORD size) {
+    auto it = mappedViews().find(hFile);
+    if (it == mappedViews().end() || offset < 0 || offset + size > it->second.size) {
+        return NULL;
+    }
+    return it->second.data + offset;
+}
 
 HANDLE openFile(const string& filename, bool createNew) {
     DWORD access = GENERIC_READ | GENERIC_WRITE;
@@ -16,78 +36,200 @@ HANDLE openFile(const string& filename, bool createNew) {
     return hFile;
 }
 
-bool initializeQueueFile(HANDLE hFile, int capacity) {
-    QueueHeader q = { capacity, 0, 0, 0 };
-    DWORD rw;
+static bool resizeQueueFile(HANDLE hFile, LONGLONG size) {
+    LARGE_INTEGER end;
+    end.QuadPart = size;
+    return SetFilePointerEx(hFile, end, NULL, FILE_BEGIN) && SetEndOfFile(hFile);
+}
+
+static bool zeroFillQueueFile(HANDLE hFile, LONGLONG size) {
+    vector<char> zeros(ZERO_FILL_CHUNK, 0);
+    LARGE_INTEGER start = {};
+    if (!SetFilePointerEx(hFile, start, NULL, FILE_BEGIN)) {
+        return false;
+    }
+
+    for (LONGLONG written = 0; written < size;) {
+        DWORD chunk = (DWORD)min((LONGLONG)zeros.size(), size - written);
+        DWORD rw;
+        if (!WriteFile(hFile, zeros.data(), chunk, &rw, NULL)) {
+            return false;
+        }
+        written += chunk;
+    }
+    return true;
+}
+
+bool initializeQueueFile(HANDLE hFile, int capacity, int overflowPolicy, int blockTimeout) {
+    if (capacity <= 0) {
+        cout << "Invalid queue capacity: " << capacity << "\n";
+        return false;
+    }
 
-    if (!WriteFile(hFile, &q, sizeof(q), &rw, NULL)) {
+    unmapQueueFile(hFile);
+
+    DWORD returned = 0;
+    bool sparse = DeviceIoControl(hFile, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &returned, NULL) != FALSE;
+    if (!sparse) {
         DWORD error = GetLastError();
-        cout << "Failed to write queue header. Error code: " << error << "\n";
+        cout << "Queue file cannot be made sparse, zero-filling message storage. Error code: " << error << "\n";
+    }
+
+    QueueHeader q = { capacity, 0, 0, 0, overflowPolicy, blockTimeout, 0, 0, 0, 0 };
+    LONGLONG size = slotOffset(q, capacity);
+    if (!resizeQueueFile(hFile, 0) || !(sparse ? resizeQueueFile(hFile, size) : zeroFillQueueFile(hFile, size))) {
+        DWORD error = GetLastError();
+        cout << "Failed to allocate message storage. Error code: " << error << "\n";
         return false;
     }
 
-    vector<char> zeros(MSG_SIZE * capacity, 0);
-    if (!WriteFile(hFile, zeros.data(), zeros.size(), &rw, NULL)) {
+    return writeQueueHeader(hFile, q);
+}
+
+LONGLONG slotOffset(const QueueHeader& header, int index) {
+    return sizeof(header) + (LONGLONG)index * SLOT_SIZE;
+}
+
+static void seekTo(HANDLE hFile, LONGLONG offset) {
+    LARGE_INTEGER position;
+    position.QuadPart = offset;
+    SetFilePointerEx(hFile, position, NULL, FILE_BEGIN);
+}
+
+bool readBlock(HANDLE hFile, LONGLONG offset, void* data, DWORD size, const string& context) {
+    char* view = mappedBlock(hFile, offset, size);
+    if (view) {
+        memcpy(data, view, size);
+        return true;
+    }
+
+    DWORD rw = 0;
+    seekTo(hFile, offset);
+
+    if (!ReadFile(hFile, data, size, &rw, NULL)) {
         DWORD error = GetLastError();
-        cout << "Failed to initialize message storage. Error code: " << error << "\n";
+        cout << context << " Error code: " << error << "\n";
         return false;
     }
 
+    if (rw < size) {
+        memset((char*)data + rw, 0, size - rw);
+    }
+
     return true;
 }
 
-bool readQueueHeader(HANDLE hFile, QueueHeader& header) {
+bool writeBlock(HANDLE hFile, LONGLONG offset, const void* data, DWORD size, const string& context) {
+    char* view = mappedBlock(hFile, offset, size);
+    if (view) {
+        memcpy(view, data, size);
+        return true;
+    }
+
     DWORD rw;
-    SetFilePointer(hFile, 0, NULL, FILE_BEGIN);
+    seekTo(hFile, offset);
 
-    if (!ReadFile(hFile, &header, sizeof(header), &rw, NULL)) {
+    if (!WriteFile(hFile, data, size, &rw, NULL)) {
         DWORD error = GetLastError();
-        cout << "Failed to read queue header. Error code: " << error << "\n";
+        cout << context << " Error code: " << error << "\n";
         return false;
     }
 
     return true;
 }
 
-bool writeQueueHeader(HANDLE hFile, const QueueHeader& header) {
-    DWORD rw;
-    SetFilePointer(hFile, 0, NULL, FILE_BEGIN);
+bool mapQueueFile(HANDLE hFile, LONGLONG size, DWORD node) {
+    unmapQueueFile(hFile);
 
-    if (!WriteFile(hFile, &header, sizeof(header), &rw, NULL)) {
+    HANDLE hMapping = CreateFileMappingNumaA(hFile, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, NULL, node);
+    if (!hMapping) {
         DWORD error = GetLastError();
-        cout << "Failed to write queue header. Error code: " << error << "\n";
+        cout << "Failed to create queue file mapping. Error code: " << error << "\n";
         return false;
     }
 
+    char* data = (char*)MapViewOfFileExNuma(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)size, NULL, node);
+    if (!data) {
+        DWORD error = GetLastError();
+        cout << "Failed to map queue file. Error code: " << error << "\n";
+        CloseHandle(hMapping);
+        return false;
+    }
+
+    mappedViews()[hFile] = { hMapping, data, size };
     return true;
 }
 
-bool readMessage(HANDLE hFile, const QueueHeader& header, int index, char* buffer) {
-    DWORD rw;
-    SetFilePointer(hFile, sizeof(header) + index * MSG_SIZE, NULL, FILE_BEGIN);
+void unmapQueueFile(HANDLE hFile) {
+    auto it = mappedViews().find(hFile);
+    if (it == mappedViews().end()) {
+        return;
+    }
 
-    if (!ReadFile(hFile, buffer, MSG_SIZE, &rw, NULL)) {
+    UnmapViewOfFile(it->second.data);
+    CloseHandle(it->second.hMapping);
+    mappedViews().erase(it);
+}
+
+bool flushQueueFile(HANDLE hFile) {
+    auto it = mappedViews().find(hFile);
+    if (it != mappedViews().end() && !FlushViewOfFile(it->second.data, it->second.size)) {
         DWORD error = GetLastError();
-        cout << "Failed to read message. Error code: " << error << "\n";
+        cout << "Failed to flush queue file mapping. Error code: " << error << "\n";
+        return false;
+    }
+
+    if (!FlushFileBuffers(hFile)) {
+        DWORD error = GetLastError();
+        cout << "Failed to flush queue file. Error code: " << error << "\n";
         return false;
     }
 
-    buffer[MSG_SIZE] = '\0'; 
     return true;
 }
 
-bool writeMessage(HANDLE hFile, const QueueHeader& header, int index, const string& message) {
-    DWORD rw;
-    SetFilePointer(hFile, sizeof(header) + index * MSG_SIZE, NULL, FILE_BEGIN);
+bool readQueueHeader(HANDLE hFile, QueueHeader& header) {
+    return readBlock(hFile, 0, &header, sizeof(header), "Failed to read queue header.");
+}
 
-    char buf[MSG_SIZE] = { 0 };
-    memcpy(buf, message.c_str(), min(message.size(), (size_t)MSG_SIZE));
+bool writeQueueHeader(HANDLE hFile, const QueueHeader& header) {
+    return writeBlock(hFile, 0, &header, sizeof(header), "Failed to write queue header.");
+}
 
-    if (!WriteFile(hFile, buf, MSG_SIZE, &rw, NULL)) {
-        DWORD error = GetLastError();
-        cout << "Failed to write message. Error code: " << error << "\n";
+bool readMessage(HANDLE hFile, const QueueHeader& header, int index, char* buffer, MessageMeta* meta) {
+    SlotHeader slot;
+    if (!readSlot(hFile, header, index, slot, buffer)) {
         return false;
     }
 
+    if (meta) {
+        *meta = slot.meta;
+    }
     return true;
+}
+
+bool writeMessage(HANDLE hFile, const QueueHeader& header, int index, const string& message, const MessageMeta& meta) {
+    char slot[SLOT_SIZE] = { 0 };
+    SlotHeader slotHeader = { SLOT_READY, meta, 0, 0 };
+    memcpy(slot, &slotHeader, sizeof(SlotHeader));
+    memcpy(slot + sizeof(SlotHeader), message.c_str(), min(message.size(), (size_t)MSG_SIZE));
+
+    return writeBlock(hFile, slotOffset(header, index), slot, SLOT_SIZE, "Failed to write message.");
+}
+
+bool readSlot(HANDLE hFile, const QueueHeader& header, int index, SlotHeader& slot, char* buffer) {
+    char raw[SLOT_SIZE];
+    if (!readBlock(hFile, slotOffset(header, index), raw, SLOT_SIZE, "Failed to read message.")) {
+        return false;
+    }
+
+    memcpy(&slot, raw, sizeof(SlotHeader));
+    memcpy(buffer, raw + sizeof(SlotHeader), MSG_SIZE);
+    buffer[MSG_SIZE] = '\0'; 
+    return true;
+}
+
+bool writeSlotState(HANDLE hFile, const QueueHeader& header, int index, int state) {
+    return writeBlock(hFile, slotOffset(header, index) + offsetof(SlotHeader, state), &state, sizeof(state),
+        "Failed to write slot state.");
 }
\ No newline at end of file
@@ -14,16 +14,61 @@ struct QueueHeader {
     int head;           
     int tail;           
     int count;          
+    int overflowPolicy;
+    int blockTimeout;
+    int timedOut;
+    int droppedOldest;
+    int droppedNewest;
+    int rejected;
+};
+
+struct MessageMeta {
+    int senderId;
+    int correlationId;
+    int tag;
+};
+
+struct SlotHeader {
+    int state;
+    MessageMeta meta;
+    int nextFromSender;
+    int nextWithTag;
 };
 #pragma pack(pop)
 
+enum SlotState {
+    SLOT_EMPTY = 0,
+    SLOT_READY = 1,
+    SLOT_CONSUMED = 2,
+    SLOT_RESERVED = 3
+};
+
+enum OverflowPolicy {
+    OVERFLOW_BLOCK = 0,
+    OVERFLOW_DROP_OLDEST = 1,
+    OVERFLOW_DROP_NEWEST = 2,
+    OVERFLOW_FAIL = 3
+};
+
 const int MSG_SIZE = 20;
+const int SLOT_SIZE = sizeof(SlotHeader) + MSG_SIZE;
+const DWORD ZERO_FILL_CHUNK = 1 << 20;
 
 HANDLE openFile(const string& filename, bool createNew = false);
-bool initializeQueueFile(HANDLE hFile, int capacity);
+bool initializeQueueFile(HANDLE hFile, int capacity, int overflowPolicy = OVERFLOW_BLOCK, int blockTimeout = 0);
 bool readQueueHeader(HANDLE hFile, QueueHeader& header);
 bool writeQueueHeader(HANDLE hFile, const QueueHeader& header);
-bool readMessage(HANDLE hFile, const QueueHeader& header, int index, char* buffer);
-bool writeMessage(HANDLE hFile, const QueueHeader& header, int index, const string& message);
+bool readMessage(HANDLE hFile, const QueueHeader& header, int index, char* buffer, MessageMeta* meta = NULL);
+bool writeMessage(HANDLE hFile, const QueueHeader& header, int index, const string& message, const MessageMeta& meta = MessageMeta());
+bool readSlot(HANDLE hFile, const QueueHeader& header, int index, SlotHeader& slot, char* buffer);
+bool writeSlotState(HANDLE hFile, const QueueHeader& header, int index, int state);
+
+LONGLONG slotOffset(const QueueHeader& header, int index);
+bool readBlock(HANDLE hFile, LONGLONG offset, void* data, DWORD size, const string& context);
+bool writeBlock(HANDLE hFile, LONGLONG offset, const void* data, DWORD size, const string& context);
+
+bool mapQueueFile(HANDLE hFile, LONGLONG size, DWORD node);
+void unmapQueueFile(HANDLE hFile);
+bool flushQueueFile(HANDLE hFile);
 
 #endif
\ No newline at end of file
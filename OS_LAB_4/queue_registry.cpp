@@ -0,0 +1,149 @@
+#include "queue_registry.h"
+#include "overflow.h"
+
+static HANDLE registryMapping = NULL;
+static QueueRegistry* registry = NULL;
+
+static bool openRegistry() {
+    if (registry) {
+        return true;
+    }
+
+    registryMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(QueueRegistry), "QueueRegistry");
+    if (!registryMapping) {
+        printError("Failed to open queue registry");
+        return false;
+    }
+
+    registry = (QueueRegistry*)MapViewOfFile(registryMapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(QueueRegistry));
+    if (!registry) {
+        printError("Failed to map queue registry");
+        CloseHandle(registryMapping);
+        registryMapping = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static void closeRegistry() {
+    if (registry) {
+        UnmapViewOfFile(registry);
+        CloseHandle(registryMapping);
+        registry = NULL;
+        registryMapping = NULL;
+    }
+}
+
+static void copyName(char* dest, size_t size, const string& src) {
+    size_t n = min(src.size(), size - 1);
+    memcpy(dest, src.c_str(), n);
+    dest[n] = '\0';
+}
+
+bool registerQueue(const string& name, const string& filename) {
+    HANDLE hMutex = createMutex("QueueRegistryMutex");
+    if (!hMutex || !openRegistry() || !waitForObject(hMutex, "Waiting for queue registry")) {
+        cleanupHandles({ hMutex });
+        return false;
+    }
+
+    char fullPath[MAX_PATH];
+    DWORD length = GetFullPathNameA(filename.c_str(), MAX_PATH, fullPath, NULL);
+    string path = length > 0 && length < MAX_PATH ? string(fullPath) : filename;
+
+    RegistryEntry* freeEntry = NULL;
+    bool ok = true;
+
+    for (RegistryEntry& entry : registry->entries) {
+        bool alive = isProcessAlive(entry.pid);
+        if (alive && name == entry.name) {
+            cout << "Queue " << name << " is already served by process " << entry.pid << "\n";
+            ok = false;
+            break;
+        }
+        if (alive && lstrcmpiA(path.c_str(), entry.path) == 0) {
+            cout << "File " << path << " is already served by process " << entry.pid << " as queue " << entry.name << "\n";
+            ok = false;
+            break;
+        }
+        if (!alive && !freeEntry) {
+            freeEntry = &entry;
+        }
+    }
+
+    if (ok && !freeEntry) {
+        cout << "Queue registry is full\n";
+        ok = false;
+    }
+
+    if (ok) {
+        freeEntry->pid = GetCurrentProcessId();
+        copyName(freeEntry->name, sizeof(freeEntry->name), name);
+        copyName(freeEntry->path, sizeof(freeEntry->path), path);
+    }
+
+    ReleaseMutex(hMutex);
+    CloseHandle(hMutex);
+    return ok;
+}
+
+void unregisterQueue(const string& name) {
+    HANDLE hMutex = createMutex("QueueRegistryMutex");
+    if (!hMutex || !registry || !waitForObject(hMutex, "Waiting for queue registry")) {
+        cleanupHandles({ hMutex });
+        return;
+    }
+
+    for (RegistryEntry& entry : registry->entries) {
+        if (entry.pid == GetCurrentProcessId() && name == entry.name) {
+            entry = RegistryEntry();
+        }
+    }
+
+    ReleaseMutex(hMutex);
+    CloseHandle(hMutex);
+    closeRegistry();
+}
+
+vector<RegistryEntry> liveQueues() {
+    vector<RegistryEntry> queues;
+
+    HANDLE hMutex = createMutex("QueueRegistryMutex");
+    if (!hMutex || !openRegistry() || !waitForObject(hMutex, "Waiting for queue registry")) {
+        cleanupHandles({ hMutex });
+        return queues;
+    }
+
+    for (const RegistryEntry& entry : registry->entries) {
+        if (isProcessAlive(entry.pid)) {
+            queues.push_back(entry);
+        }
+    }
+
+    ReleaseMutex(hMutex);
+    CloseHandle(hMutex);
+    return queues;
+}
+
+void listQueues() {
+    vector<RegistryEntry> queues = liveQueues();
+    if (queues.empty()) {
+        cout << "No live queues\n";
+    }
+
+    for (const RegistryEntry& entry : queues) {
+        cout << entry.name << " (PID " << entry.pid << "): " << entry.path << "\n";
+
+        HANDLE hFile = openFile(entry.path);
+        if (hFile == INVALID_HANDLE_VALUE) {
+            continue;
+        }
+
+        QueueHeader q;
+        if (readQueueHeader(hFile, q)) {
+            printQueueStats(q);
+        }
+        CloseHandle(hFile);
+    }
+}
\ No newline at end of file
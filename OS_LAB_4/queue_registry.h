@@ -0,0 +1,32 @@
+#ifndef QUEUE_REGISTRY_H
+#define QUEUE_REGISTRY_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "queue_file.h"
+#include "sync_utils.h"
+
+using namespace std;
+
+const int MAX_REGISTERED_QUEUES = 64;
+
+#pragma pack(push,1)
+struct RegistryEntry {
+    DWORD pid;
+    char name[MAX_QUEUE_NAME + 1];
+    char path[MAX_PATH];
+};
+
+struct QueueRegistry {
+    RegistryEntry entries[MAX_REGISTERED_QUEUES];
+};
+#pragma pack(pop)
+
+bool registerQueue(const string& name, const string& filename);
+void unregisterQueue(const string& name);
+vector<RegistryEntry> liveQueues();
+void listQueues();
+
+#endif
\ No newline at end of file
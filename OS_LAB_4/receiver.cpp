@@ -1,50 +1,148 @@
 #include "receiver.h"
 
-void processReadCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull) {
- 
-    if (!waitForObject(evNotEmpty, "Waiting for messages")) {
-        return;
-    }
-
-  
-    if (!waitForObject(hMutex, "Waiting for mutex")) {
-        return;
+TakeResult tryDequeueMessage(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, char* buffer, MessageMeta* meta,
+    const MessageFilter& filter, HANDLE* hOwner, DWORD* wakeAfter) {
+    HANDLE evWait = filter.kind == MATCH_ANY ? evNotEmpty : filterEvent(filter);
+    if (!evWait || !waitForObject(hMutex, "Waiting for mutex")) {
+        return TAKE_ERROR;
     }
 
-  
     QueueHeader h;
-    if (!readQueueHeader(hFile, h)) {
+    MessageIndex index;
+    if (!readQueueHeader(hFile, h) || !readMessageIndex(hFile, h, index) ||
+        !promoteDueMessages(hFile, evNotEmpty, h, index)) {
         ReleaseMutex(hMutex);
-        return;
+        return TAKE_ERROR;
     }
 
-    int index = h.head;
-    h.head = (h.head + 1) % h.capacity;
-    h.count--;
+    TakeResult result = takeMessage(hFile, h, index, filter, buffer, meta);
+    if (result == TAKE_ERROR) {
+        ReleaseMutex(hMutex);
+        return TAKE_ERROR;
+    }
 
-    char buf[MSG_SIZE + 1] = { 0 };
-    if (!readMessage(hFile, h, index, buf)) {
+    if (result == TAKE_EMPTY || result == TAKE_BLOCKED) {
+        if (result == TAKE_BLOCKED && hOwner) {
+            *hOwner = openReservationOwner(hFile, h, h.head);
+        }
+        if (wakeAfter) {
+            *wakeAfter = delayedWakeTime(hFile, h);
+        }
+        writeMessageIndex(hFile, h, index);
+        writeQueueHeader(hFile, h);
+        ResetEvent(evWait);
         ReleaseMutex(hMutex);
-        return;
+        return result;
     }
 
-    if (!writeQueueHeader(hFile, h)) {
+    if (!writeMessageIndex(hFile, h, index) || !writeQueueHeader(hFile, h)) {
         ReleaseMutex(hMutex);
-        return;
+        return TAKE_ERROR;
     }
 
-    if (h.count == 0) {
+    if (index.live == 0) {
         ResetEvent(evNotEmpty);
     }
     SetEvent(evNotFull);
 
     ReleaseMutex(hMutex);
-    cout << "Received: " << buf << endl;
+    return TAKE_OK;
+}
+
+bool dequeueMessage(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, char* buffer, MessageMeta* meta, DWORD timeout, const MessageFilter& filter) {
+    HANDLE evWait = filter.kind == MATCH_ANY ? evNotEmpty : filterEvent(filter);
+    if (!evWait) {
+        return false;
+    }
+
+    HANDLE hOwner = NULL;
+    DWORD wakeAfter = 0;
+    DWORD started = GetTickCount();
+
+    while (true) {
+        bool woken = waitForMessages(evWait, hOwner, started, timeout, wakeAfter);
+        cleanupHandles({ hOwner });
+        hOwner = NULL;
+
+        if (!woken) {
+            return false;
+        }
+
+        TakeResult result = tryDequeueMessage(hFile, hMutex, evNotEmpty, evNotFull, buffer, meta, filter, &hOwner, &wakeAfter);
+        if (result == TAKE_OK || result == TAKE_ERROR) {
+            return result == TAKE_OK;
+        }
+    }
+}
+
+void processReadCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, MessageMeta& lastRequest, const MessageFilter& filter) {
+    char buf[MSG_SIZE + 1] = { 0 };
+    MessageMeta meta;
+    if (!dequeueMessage(hFile, hMutex, evNotEmpty, evNotFull, buf, &meta, 5000, filter)) {
+        return;
+    }
+
+    if (meta.correlationId != 0) {
+        lastRequest = meta;
+        cout << "Received request #" << meta.correlationId << " from sender #" << meta.senderId << ": " << buf << endl;
+    }
+    else {
+        cout << "Received: " << buf << endl;
+    }
+}
+
+static bool replyTo(const string& filename, map<int, ReplyChannel>& channels, const MessageMeta& request, const string& reply) {
+    auto it = channels.find(request.senderId);
+    if (it == channels.end()) {
+        ReplyChannel channel;
+        if (!openReplyChannel(filename, request.senderId, channel)) {
+            return false;
+        }
+        it = channels.emplace(request.senderId, channel).first;
+    }
+
+    return sendReply(it->second, request, reply);
+}
+
+void processReplyCommand(const string& filename, map<int, ReplyChannel>& channels, MessageMeta& lastRequest) {
+    if (lastRequest.correlationId == 0) {
+        cout << "No request to reply to\n";
+        return;
+    }
+
+    cout << "Reply: ";
+    string reply;
+    cin.ignore();
+    getline(cin, reply);
+
+    if (replyTo(filename, channels, lastRequest, reply)) {
+        cout << "Reply sent to sender #" << lastRequest.senderId << "\n";
+        lastRequest = MessageMeta();
+    }
+}
+
+int serveRequests(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, const string& filename, map<int, ReplyChannel>& channels, int maxRequests) {
+    int served = 0;
+    while (maxRequests <= 0 || served < maxRequests) {
+        char buf[MSG_SIZE + 1] = { 0 };
+        MessageMeta meta;
+        if (!dequeueMessage(hFile, hMutex, evNotEmpty, evNotFull, buf, &meta)) {
+            break;
+        }
+
+        if (meta.correlationId != 0 && replyTo(filename, channels, meta, buf)) {
+            served++;
+        }
+    }
+    return served;
 }
 
-void handleReceiverCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull) {
+void handleReceiverCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, const string& filename) {
+    map<int, ReplyChannel> channels;
+    MessageMeta lastRequest = MessageMeta();
+
     while (true) {
-        cout << "Receiver command (read/exit): ";
+        cout << "Receiver command (read [--from <id> | --tag <t>] / reply / serve <n> / drain [<n>] [--out <file>] / stats / exit): ";
         string cmd;
         cin >> cmd;
 
@@ -52,15 +150,55 @@ void handleReceiverCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HAND
             break;
         }
         else if (cmd == "read") {
-            processReadCommand(hFile, hMutex, evNotEmpty, evNotFull);
+            string args;
+            getline(cin, args);
+
+            MessageFilter filter;
+            if (parseFilter(args, filter)) {
+                processReadCommand(hFile, hMutex, evNotEmpty, evNotFull, lastRequest, filter);
+            }
+            else {
+                cout << "Usage: read [--from <0.." << MAX_INDEXED_SENDERS - 1 << "> | --tag <0.." << MAX_TAGS - 1 << ">]\n";
+            }
+        }
+        else if (cmd == "reply") {
+            processReplyCommand(filename, channels, lastRequest);
+        }
+        else if (cmd == "serve") {
+            int n;
+            cin >> n;
+            cout << "Served " << serveRequests(hFile, hMutex, evNotEmpty, evNotFull, filename, channels, n) << " requests\n";
+        }
+        else if (cmd == "stats") {
+            processStatsCommand(hFile, hMutex);
+        }
+        else if (cmd == "drain") {
+            string args, outputFile;
+            long long n;
+            getline(cin, args);
+
+            if (parseDrainArgs(args, n, outputFile)) {
+                processDrainCommand(hFile, hMutex, evNotEmpty, evNotFull, n, outputFile);
+            }
+            else {
+                cout << "Usage: drain [<n>] [--out <file>]\n";
+            }
         }
         else {
             cout << "Unknown command\n";
         }
     }
+
+    for (auto& entry : channels) {
+        closeReplyChannel(entry.second);
+    }
 }
 
-void runReceiver() {
+void runReceiver(bool broadcast, const LaunchOptions& options) {
+    if (!applyPlacement(GetCurrentProcess(), options.receiver, "receiver")) {
+        return;
+    }
+
     string filename;
     int capacity;
 
@@ -69,25 +207,62 @@ void runReceiver() {
     cout << "Number of records: ";
     cin >> capacity;
 
+    bool dropLagging = false;
+    if (broadcast) {
+        string answer;
+        cout << "Drop lagging subscribers (y/n): ";
+        cin >> answer;
+        dropLagging = answer == "y" || answer == "yes";
+    }
+
+    setQueueNamespace(options.queueName.empty() ? queueNameFromPath(filename) : options.queueName);
+    if (!registerQueue(queueNamespace(), filename)) {
+        return;
+    }
+    cout << "Queue name: " << queueNamespace() << "\n";
+
     HANDLE hFile = openFile(filename, true);
     if (hFile == INVALID_HANDLE_VALUE) {
+        unregisterQueue(queueNamespace());
+        return;
+    }
+
+    if (!initializeQueueFile(hFile, capacity, options.overflowPolicy, options.blockTimeout)) {
+        CloseHandle(hFile);
+        unregisterQueue(queueNamespace());
         return;
     }
 
-    if (!initializeQueueFile(hFile, capacity)) {
+    if (broadcast && !initializeBroadcast(hFile, { capacity, 0, 0, 0 }, dropLagging)) {
         CloseHandle(hFile);
+        unregisterQueue(queueNamespace());
         return;
     }
 
-    HANDLE hMutex = createMutex();
-    HANDLE evNotEmpty = createEvent("QueueNotEmpty", false);
-    HANDLE evNotFull = createEvent("QueueNotFull", true);
+    HANDLE hMutex = createMutex(queueObjectName("QueueMutex"));
+    HANDLE evNotEmpty = createEvent(queueObjectName("QueueNotEmpty"), false);
+    HANDLE evNotFull = createEvent(queueObjectName("QueueNotFull"), true);
 
     if (!hMutex || !evNotEmpty || !evNotFull) {
         cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+        unregisterQueue(queueNamespace());
         return;
     }
 
+    HANDLE evSubscriber = NULL;
+    if (broadcast) {
+        evSubscriber = createEvent(subscriberEventName(0), false);
+        if (!evSubscriber || !subscribe(hFile, hMutex, 0)) {
+            cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull, evSubscriber });
+            unregisterQueue(queueNamespace());
+            return;
+        }
+    }
+
+    if (isPinned(options.receiver) && !mapQueueOnNode(hFile, { capacity, 0, 0, 0 }, options.receiver)) {
+        cout << "Using unmapped file I/O\n";
+    }
+
     int nSenders;
     cout << "Number of senders: ";
     cin >> nSenders;
@@ -95,17 +270,31 @@ void runReceiver() {
     vector<HANDLE> readyEvents = createReadyEvents(nSenders);
 
  
-    vector<PROCESS_INFORMATION> processes = startAllSenders(filename, nSenders);
+    bool pinSenders = hasPinnedSenders(options);
+    vector<ChildProcess> processes = startAllSenders(filename, nSenders, pinSenders);
+    if (pinSenders) {
+        resumePinnedProcesses(processes, options);
+    }
 
     
     waitForSendersReady(readyEvents);
 
 
-    handleReceiverCommands(hFile, hMutex, evNotEmpty, evNotFull);
+    if (evSubscriber) {
+        cout << "Receiver is subscriber #0. Start more subscribers with:\n"
+            << "  OS_LAB_4.exe subscriber " << filename << " <id>\n";
+        handleSubscriberCommands(hFile, hMutex, evNotFull, evSubscriber, 0);
+    }
+    else {
+        handleReceiverCommands(hFile, hMutex, evNotEmpty, evNotFull, filename);
+    }
 
    
     terminateAllSenders(processes);
 
     cleanupHandles(readyEvents);
-    cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+    unmapQueueFile(hFile);
+    cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull, evSubscriber });
+    closeFilterEvents();
+    unregisterQueue(queueNamespace());
 }
\ No newline at end of file
@@ -4,13 +4,29 @@
 #include <windows.h>
 #include <iostream>
 #include <string>
+#include <map>
 #include "queue_file.h"
 #include "sync_utils.h"
+#include "subscriber.h"
+#include "reply_channel.h"
+#include "message_index.h"
+#include "drain.h"
+#include "placement.h"
+#include "overflow.h"
+#include "queue_registry.h"
+#include "transaction.h"
+#include "timing_wheel.h"
 
 using namespace std;
 
-void runReceiver();
-void handleReceiverCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull);
-void processReadCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull);
+void runReceiver(bool broadcast = false, const LaunchOptions& options = LaunchOptions());
+void handleReceiverCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, const string& filename);
+void processReadCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, MessageMeta& lastRequest, const MessageFilter& filter);
+void processReplyCommand(const string& filename, map<int, ReplyChannel>& channels, MessageMeta& lastRequest);
+int serveRequests(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, const string& filename, map<int, ReplyChannel>& channels, int maxRequests);
+TakeResult tryDequeueMessage(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, char* buffer, MessageMeta* meta,
+    const MessageFilter& filter = { MATCH_ANY, 0 }, HANDLE* hOwner = NULL, DWORD* wakeAfter = NULL);
+bool dequeueMessage(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, char* buffer, MessageMeta* meta = NULL, DWORD timeout = 5000,
+    const MessageFilter& filter = { MATCH_ANY, 0 });
 
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "reply_channel.h"
+#include "sender.h"
+#include "receiver.h"
+
+string replyFileName(const string& filename, int senderId) {
+    return filename + ".reply" + to_string(senderId);
+}
+
+bool createReplyChannel(const string& filename, int senderId, ReplyChannel& channel) {
+    string id = to_string(senderId);
+    channel = { INVALID_HANDLE_VALUE, NULL, NULL, NULL };
+
+    channel.hFile = openFile(replyFileName(filename, senderId), true);
+    if (channel.hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    channel.hMutex = createMutex(queueObjectName("ReplyMutex_" + id));
+    channel.evNotEmpty = createEvent(queueObjectName("ReplyNotEmpty_" + id), false);
+    channel.evNotFull = createEvent(queueObjectName("ReplyNotFull_" + id), true);
+
+    if (!channel.hMutex || !channel.evNotEmpty || !channel.evNotFull ||
+        !initializeQueueFile(channel.hFile, REPLY_CAPACITY)) {
+        closeReplyChannel(channel);
+        return false;
+    }
+
+    return true;
+}
+
+bool openReplyChannel(const string& filename, int senderId, ReplyChannel& channel) {
+    string id = to_string(senderId);
+    channel = { INVALID_HANDLE_VALUE, NULL, NULL, NULL };
+
+    channel.hFile = openFile(replyFileName(filename, senderId));
+    if (channel.hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    channel.hMutex = openMutex(queueObjectName("ReplyMutex_" + id));
+    channel.evNotEmpty = openEvent(queueObjectName("ReplyNotEmpty_" + id));
+    channel.evNotFull = openEvent(queueObjectName("ReplyNotFull_" + id));
+
+    if (!channel.hMutex || !channel.evNotEmpty || !channel.evNotFull) {
+        closeReplyChannel(channel);
+        return false;
+    }
+
+    return true;
+}
+
+void closeReplyChannel(ReplyChannel& channel) {
+    if (channel.hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(channel.hFile);
+    }
+    cleanupHandles({ channel.hMutex, channel.evNotEmpty, channel.evNotFull });
+    channel = { INVALID_HANDLE_VALUE, NULL, NULL, NULL };
+}
+
+bool sendReply(const ReplyChannel& channel, const MessageMeta& request, const string& reply) {
+    return enqueueMessage(channel.hFile, channel.hMutex, channel.evNotFull, channel.evNotEmpty, reply, request) == ENQUEUE_OK;
+}
+
+bool callRequest(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const ReplyChannel& channel,
+    const MessageMeta& request, const string& message, char* reply, DWORD timeout) {
+    EnqueueResult sent = enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, message, request);
+    if (sent == ENQUEUE_DROPPED) {
+        cout << "Queue is full, request #" << request.correlationId << " dropped\n";
+    }
+    if (sent != ENQUEUE_OK) {
+        return false;
+    }
+
+    DWORD start = GetTickCount();
+    while (true) {
+        DWORD elapsed = GetTickCount() - start;
+        if (elapsed >= timeout) {
+            cout << "Waiting for reply timeout\n";
+            return false;
+        }
+
+        MessageMeta meta;
+        if (!dequeueMessage(channel.hFile, channel.hMutex, channel.evNotEmpty, channel.evNotFull,
+            reply, &meta, timeout - elapsed)) {
+            return false;
+        }
+
+        if (meta.correlationId == request.correlationId) {
+            return true;
+        }
+    }
+}
\ No newline at end of file
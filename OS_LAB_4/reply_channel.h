@@ -0,0 +1,31 @@
+#ifndef REPLY_CHANNEL_H
+#define REPLY_CHANNEL_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include "queue_file.h"
+#include "sync_utils.h"
+
+using namespace std;
+
+const int REPLY_CAPACITY = 16;
+const DWORD CALL_TIMEOUT = 5000;
+
+struct ReplyChannel {
+    HANDLE hFile;
+    HANDLE hMutex;
+    HANDLE evNotEmpty;
+    HANDLE evNotFull;
+};
+
+string replyFileName(const string& filename, int senderId);
+bool createReplyChannel(const string& filename, int senderId, ReplyChannel& channel);
+bool openReplyChannel(const string& filename, int senderId, ReplyChannel& channel);
+void closeReplyChannel(ReplyChannel& channel);
+
+bool sendReply(const ReplyChannel& channel, const MessageMeta& request, const string& reply);
+bool callRequest(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const ReplyChannel& channel,
+    const MessageMeta& request, const string& message, char* reply, DWORD timeout = CALL_TIMEOUT);
+
+#endif
\ No newline at end of file
@@ -1,66 +1,313 @@
 #include "sender.h"
+#include <sstream>
 
-void processSendCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty) {
-    cout << "Message: ";
-    string msg;
-    cin.ignore();
-    getline(cin, msg);
-
-    if (msg.size() > MSG_SIZE) {
-        msg.resize(MSG_SIZE);
+static bool publishToSubscribers(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, QueueHeader& q, BroadcastSection& section, const string& msg, const MessageMeta& meta) {
+    if (!publishMessage(hFile, q, section, msg, meta)) {
+        if (q.count == q.capacity) {
+            ResetEvent(evNotFull);
+        }
+        ReleaseMutex(hMutex);
+        return false;
     }
 
-
-    if (!waitForObject(evNotFull, "Waiting for space in queue")) {
-        return;
+    if (q.count == q.capacity && !section.dropLagging) {
+        ResetEvent(evNotFull);
     }
 
+    ReleaseMutex(hMutex);
+    notifySubscribers(section);
+    return true;
+}
+
+EnqueueResult tryEnqueueMessage(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const string& msg, const MessageMeta& meta, QueueHeader& q) {
     if (!waitForObject(hMutex, "Waiting for mutex")) {
-        return;
+        return ENQUEUE_ERROR;
     }
 
-    QueueHeader q;
     if (!readQueueHeader(hFile, q)) {
         ReleaseMutex(hMutex);
-        return;
+        return ENQUEUE_ERROR;
+    }
+
+    BroadcastSection section;
+    if (!readBroadcastSection(hFile, q, section)) {
+        ReleaseMutex(hMutex);
+        return ENQUEUE_ERROR;
+    }
+
+    if (isBroadcastQueue(section)) {
+        if (publishToSubscribers(hFile, hMutex, evNotFull, q, section, msg, meta)) {
+            return ENQUEUE_OK;
+        }
+        return q.count < q.capacity ? ENQUEUE_ERROR : ENQUEUE_FULL;
+    }
+
+    MessageIndex messageIndex;
+    if (!readMessageIndex(hFile, q, messageIndex) || !promoteDueMessages(hFile, evNotEmpty, q, messageIndex)) {
+        ReleaseMutex(hMutex);
+        return ENQUEUE_ERROR;
+    }
+
+    if (q.count == q.capacity) {
+        if (q.overflowPolicy == OVERFLOW_BLOCK) {
+            ResetEvent(evNotFull);
+            ReleaseMutex(hMutex);
+            return ENQUEUE_FULL;
+        }
+
+        if (q.overflowPolicy != OVERFLOW_DROP_OLDEST) {
+            bool dropped = rejectMessage(hFile, q);
+            ReleaseMutex(hMutex);
+            return dropped ? ENQUEUE_DROPPED : ENQUEUE_ERROR;
+        }
+
+        TakeResult dropped = dropOldestMessage(hFile, q, messageIndex);
+        if (dropped == TAKE_ERROR) {
+            ReleaseMutex(hMutex);
+            return ENQUEUE_ERROR;
+        }
+
+        if (dropped != TAKE_OK && q.count == q.capacity) {
+            cout << "Oldest message is reserved by an open transaction, waiting for space\n";
+            ResetEvent(evNotFull);
+            ReleaseMutex(hMutex);
+            return ENQUEUE_FULL;
+        }
     }
 
     int index = q.tail;
     q.tail = (q.tail + 1) % q.capacity;
     q.count++;
 
-    if (!writeMessage(hFile, q, index, msg)) {
+    if (!writeMessage(hFile, q, index, msg, meta)) {
         ReleaseMutex(hMutex);
-        return;
+        return ENQUEUE_ERROR;
+    }
+
+    if (!appendToIndex(hFile, q, messageIndex, index, meta) || !writeMessageIndex(hFile, q, messageIndex)) {
+        ReleaseMutex(hMutex);
+        return ENQUEUE_ERROR;
     }
 
     if (!writeQueueHeader(hFile, q)) {
         ReleaseMutex(hMutex);
-        return;
+        return ENQUEUE_ERROR;
     }
 
     ReleaseMutex(hMutex);
     SetEvent(evNotEmpty);
+    notifyFilterEvents(meta);
+    return ENQUEUE_OK;
+}
+
+EnqueueResult enqueueMessage(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const string& msg, const MessageMeta& meta, DWORD timeout) {
+    DWORD started = GetTickCount();
+
+    while (true) {
+        QueueHeader q;
+        EnqueueResult result = tryEnqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, msg, meta, q);
+        if (result != ENQUEUE_FULL) {
+            return result;
+        }
+
+        if (!waitForSpace(hFile, hMutex, evNotFull, q, started, timeout)) {
+            return ENQUEUE_FULL;
+        }
+    }
+}
+
+static string readMessageText() {
+    cout << "Message: ";
+    string msg;
+    getline(cin, msg);
+
+    if (msg.size() > MSG_SIZE) {
+        msg.resize(MSG_SIZE);
+    }
+
+    return msg;
+}
+
+void processSendCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, int senderId, int tag, DWORD delay) {
+    string msg = readMessageText();
+
+    if (delay > 0) {
+        if (enqueueDelayed(hFile, hMutex, evNotEmpty, msg, { senderId, 0, tag }, delay)) {
+            cout << "Message scheduled for delivery in " << delay << " ms\n";
+        }
+    }
+    else {
+        EnqueueResult result = enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, msg, { senderId, 0, tag });
+        if (result == ENQUEUE_OK) {
+            cout << "Message sent successfully\n";
+        }
+        else if (result == ENQUEUE_DROPPED) {
+            cout << "Queue is full, message dropped\n";
+        }
+    }
+}
+
+void processStageCommand(HANDLE hFile, Transaction& txn, int senderId, int tag) {
+    string msg = readMessageText();
+
+    if (stageMessage(hFile, txn, msg, { senderId, 0, tag })) {
+        cout << "Message staged (" << txn.staged << "/" << txn.reserved << ")\n";
+    }
+}
+
+void processCallCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const ReplyChannel& channel, int senderId, int tag, int correlationId) {
+    string msg = readMessageText();
+
+    char reply[MSG_SIZE + 1] = { 0 };
+    if (callRequest(hFile, hMutex, evNotFull, evNotEmpty, channel, { senderId, correlationId, tag }, msg, reply)) {
+        cout << "Reply #" << correlationId << ": " << reply << "\n";
+    }
+}
+
+void processBurstCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, int senderId, int tag, int count, bool durable) {
+    string msg = readMessageText();
+    vector<string> messages(count, msg);
+
+    LARGE_INTEGER frequency, start, finish;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+
+    int dropped = 0;
+    int sent = enqueueBatch(hFile, hMutex, evNotFull, evNotEmpty, messages, { senderId, 0, tag }, durable, 5000, &dropped);
+
+    QueryPerformanceCounter(&finish);
+    double seconds = double(finish.QuadPart - start.QuadPart) / frequency.QuadPart;
+
+    cout << "Sent " << sent << " of " << count << " messages";
+    if (seconds > 0) {
+        cout << " (" << (long long)(sent / seconds) << " msg/s)";
+    }
+    if (dropped > 0) {
+        cout << ", " << dropped << " dropped";
+    }
+    cout << "\n";
+}
+
+static bool parseBurstArgs(const string& args, int& count, bool& durable, MessageFilter& filter) {
+    istringstream in(args);
+    string token, rest;
+    durable = false;
+
+    if (!(in >> count) || count <= 0) {
+        return false;
+    }
+
+    while (in >> token) {
+        if (token == "--sync") {
+            durable = true;
+        }
+        else {
+            rest += " " + token;
+        }
+    }
 
-    cout << "Message sent successfully\n";
+    return parseFilter(rest, filter) && filter.kind != MATCH_SENDER;
 }
 
-void handleSenderCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty) {
+static bool parseSendArgs(const string& args, DWORD& delay, MessageFilter& filter) {
+    istringstream in(args);
+    string token, rest;
+    delay = 0;
+
+    while (in >> token) {
+        if (token == "--delay") {
+            long long ms;
+            if (!(in >> ms) || ms <= 0 || ms > MAX_DELAY_MS) {
+                return false;
+            }
+            delay = (DWORD)ms;
+        }
+        else {
+            rest += " " + token;
+        }
+    }
+
+    return parseFilter(rest, filter) && filter.kind != MATCH_SENDER;
+}
+
+void handleSenderCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const ReplyChannel& channel, int senderId) {
+    int nextCorrelationId = 1;
+    Transaction txn;
+
     while (true) {
-        cout << "Sender command (send/exit): ";
-        string cmd;
+        cout << "Sender command (send [--tag <t>] [--delay <ms>] / call [--tag <t>] / burst <n> [--tag <t>] [--sync] / begin <n> / commit / abort / stats / exit): ";
+        string cmd, args;
         cin >> cmd;
+        getline(cin, args);
+
+        MessageFilter filter;
+        if (cmd == "call" && (!parseFilter(args, filter) || filter.kind == MATCH_SENDER)) {
+            cout << "Usage: call [--tag <0.." << MAX_TAGS - 1 << ">]\n";
+            continue;
+        }
+
+        DWORD delay = 0;
+        if (cmd == "send" && !parseSendArgs(args, delay, filter)) {
+            cout << "Usage: send [--tag <0.." << MAX_TAGS - 1 << ">] [--delay <1.." << MAX_DELAY_MS << " ms>]\n";
+            continue;
+        }
+
+        int burstCount = 0;
+        bool durable = false;
+        if (cmd == "burst" && !parseBurstArgs(args, burstCount, durable, filter)) {
+            cout << "Usage: burst <n> [--tag <0.." << MAX_TAGS - 1 << ">] [--sync]\n";
+            continue;
+        }
 
         if (cmd == "exit") {
             break;
         }
+        else if (cmd == "send" && txn.entry >= 0 && delay > 0) {
+            cout << "Delayed messages cannot be staged in a transaction\n";
+        }
+        else if (cmd == "send" && txn.entry >= 0) {
+            processStageCommand(hFile, txn, senderId, filter.value);
+        }
         else if (cmd == "send") {
-            processSendCommand(hFile, hMutex, evNotFull, evNotEmpty);
+            processSendCommand(hFile, hMutex, evNotFull, evNotEmpty, senderId, filter.value, delay);
+        }
+        else if (cmd == "begin") {
+            int size = atoi(args.c_str());
+            if (txn.entry >= 0) {
+                cout << "Transaction is already open\n";
+            }
+            else if (beginTransaction(hFile, hMutex, evNotFull, size, txn)) {
+                cout << "Reserved " << size << " slots, use send to stage messages\n";
+            }
+        }
+        else if (cmd == "commit") {
+            int staged = txn.staged;
+            if (commitTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn)) {
+                cout << "Committed " << staged << " messages\n";
+            }
+        }
+        else if (cmd == "abort") {
+            if (abortTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn)) {
+                cout << "Transaction aborted\n";
+            }
+        }
+        else if (cmd == "call") {
+            processCallCommand(hFile, hMutex, evNotFull, evNotEmpty, channel, senderId, filter.value, nextCorrelationId++);
+        }
+        else if (cmd == "burst") {
+            processBurstCommand(hFile, hMutex, evNotFull, evNotEmpty, senderId, filter.value, burstCount, durable);
+        }
+        else if (cmd == "stats") {
+            processStatsCommand(hFile, hMutex);
         }
         else {
             cout << "Unknown command\n";
         }
     }
+
+    if (txn.entry >= 0) {
+        abortTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn);
+    }
 }
 
 void runSender(string filename, int senderId) {
@@ -73,19 +320,28 @@ void runSender(string filename, int senderId) {
         return;
     }
 
-    HANDLE hMutex = openMutex();
+    HANDLE hMutex = openMutex(queueObjectName("QueueMutex"));
     if (!hMutex) {
         CloseHandle(hFile);
         return;
     }
 
-    HANDLE evNotEmpty = openEvent("QueueNotEmpty");
-    HANDLE evNotFull = openEvent("QueueNotFull");
+    HANDLE evNotEmpty = openEvent(queueObjectName("QueueNotEmpty"));
+    HANDLE evNotFull = openEvent(queueObjectName("QueueNotFull"));
+
+    ReplyChannel channel;
+    if (!createReplyChannel(filename, senderId, channel)) {
+        cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+        return;
+    }
 
     signalSenderReady(senderId);
 
-    handleSenderCommands(hFile, hMutex, evNotFull, evNotEmpty);
+    handleSenderCommands(hFile, hMutex, evNotFull, evNotEmpty, channel, senderId);
+
+    closeReplyChannel(channel);
 
     vector<HANDLE> handles = { hFile, hMutex, evNotEmpty, evNotFull };
     cleanupHandles(handles);
+    closeFilterEvents();
 }
\ No newline at end of file
@@ -6,11 +6,30 @@
 #include <string>
 #include "queue_file.h"
 #include "sync_utils.h"
+#include "broadcast.h"
+#include "reply_channel.h"
+#include "message_index.h"
+#include "batch_io.h"
+#include "overflow.h"
+#include "transaction.h"
+#include "timing_wheel.h"
 
 using namespace std;
 
+enum EnqueueResult {
+    ENQUEUE_OK,
+    ENQUEUE_FULL,
+    ENQUEUE_DROPPED,
+    ENQUEUE_ERROR
+};
+
 void runSender(string filename, int senderId);
-void handleSenderCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty);
-void processSendCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty);
+void handleSenderCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const ReplyChannel& channel, int senderId);
+void processSendCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, int senderId, int tag, DWORD delay = 0);
+void processCallCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const ReplyChannel& channel, int senderId, int tag, int correlationId);
+void processStageCommand(HANDLE hFile, Transaction& txn, int senderId, int tag);
+void processBurstCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, int senderId, int tag, int count, bool durable);
+EnqueueResult tryEnqueueMessage(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const string& msg, const MessageMeta& meta, QueueHeader& q);
+EnqueueResult enqueueMessage(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evNotEmpty, const string& msg, const MessageMeta& meta, DWORD timeout = 5000);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "subscriber.h"
+
+void processSubscriberReadCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evSubscriber, int subscriberId) {
+    while (true) {
+        if (!waitForObject(evSubscriber, "Waiting for messages")) {
+            return;
+        }
+
+        if (!waitForObject(hMutex, "Waiting for mutex")) {
+            return;
+        }
+
+        QueueHeader h;
+        BroadcastSection section;
+        if (!readQueueHeader(hFile, h) || !readBroadcastSection(hFile, h, section)) {
+            ReleaseMutex(hMutex);
+            return;
+        }
+
+        if (section.subscribers[subscriberId].state != SUBSCRIBER_ACTIVE) {
+            ResetEvent(evSubscriber);
+            ReleaseMutex(hMutex);
+            cout << "Subscriber #" << subscriberId << " was dropped for lagging behind\n";
+            return;
+        }
+
+        char buf[MSG_SIZE + 1] = { 0 };
+        bool received = receiveBroadcast(hFile, h, section, subscriberId, buf);
+
+        if (section.subscribers[subscriberId].pending == 0) {
+            ResetEvent(evSubscriber);
+        }
+        if (h.count < h.capacity) {
+            SetEvent(evNotFull);
+        }
+
+        ReleaseMutex(hMutex);
+
+        if (received) {
+            cout << "Received: " << buf << endl;
+            return;
+        }
+    }
+}
+
+void handleSubscriberCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evSubscriber, int subscriberId) {
+    while (true) {
+        cout << "Subscriber command (read/exit): ";
+        string cmd;
+        cin >> cmd;
+
+        if (cmd == "exit") {
+            break;
+        }
+        else if (cmd == "read") {
+            processSubscriberReadCommand(hFile, hMutex, evNotFull, evSubscriber, subscriberId);
+        }
+        else {
+            cout << "Unknown command\n";
+        }
+    }
+}
+
+void runSubscriber(string filename, int subscriberId) {
+    cout << "Subscriber #" << subscriberId << " starting...\n";
+
+    HANDLE hFile = openFile(filename);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    HANDLE hMutex = openMutex(queueObjectName("QueueMutex"));
+    HANDLE evNotFull = openEvent(queueObjectName("QueueNotFull"));
+    HANDLE evSubscriber = createEvent(subscriberEventName(subscriberId), false);
+
+    if (!hMutex || !evNotFull || !evSubscriber) {
+        cleanupHandles({ hFile, hMutex, evNotFull, evSubscriber });
+        return;
+    }
+
+    ResetEvent(evSubscriber);
+    if (subscribe(hFile, hMutex, subscriberId)) {
+        cout << "Subscriber #" << subscriberId << " connected.\n";
+        handleSubscriberCommands(hFile, hMutex, evNotFull, evSubscriber, subscriberId);
+        unsubscribe(hFile, hMutex, subscriberId);
+        SetEvent(evNotFull);
+    }
+
+    cleanupHandles({ hFile, hMutex, evNotFull, evSubscriber });
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#ifndef SUBSCRIBER_H
+#define SUBSCRIBER_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "broadcast.h"
+
+using namespace std;
+
+void runSubscriber(string filename, int subscriberId);
+void handleSubscriberCommands(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evSubscriber, int subscriberId);
+void processSubscriberReadCommand(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, HANDLE evSubscriber, int subscriberId);
+
+#endif
\ No newline at end of file
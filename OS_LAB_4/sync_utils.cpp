@@ -1,4 +1,6 @@
 #include "sync_utils.h"
+#include <iomanip>
+#include <sstream>
 
 void printError(const string& context) {
     DWORD error = GetLastError();
@@ -22,16 +24,69 @@ void cleanupHandles(const vector<HANDLE>& handles) {
     }
 }
 
-HANDLE createMutex() {
-    HANDLE hMutex = CreateMutexA(NULL, FALSE, "QueueMutex");
+static string& currentNamespace() {
+    static string name;
+    return name;
+}
+
+string queueNameFromPath(const string& filename) {
+    char fullPath[MAX_PATH];
+    DWORD length = GetFullPathNameA(filename.c_str(), MAX_PATH, fullPath, NULL);
+    string path = length > 0 && length < MAX_PATH ? string(fullPath, length) : filename;
+
+    DWORD hash = 2166136261u;
+    for (char c : path) {
+        hash = (hash ^ (unsigned char)tolower((unsigned char)c)) * 16777619u;
+    }
+
+    size_t slash = path.find_last_of("\\/");
+    string base = slash == string::npos ? path : path.substr(slash + 1);
+    for (char& c : base) {
+        if (!isalnum((unsigned char)c) && c != '.' && c != '-') {
+            c = '_';
+        }
+    }
+
+    ostringstream suffix;
+    suffix << "_" << hex << setw(8) << setfill('0') << hash;
+    return base.substr(0, MAX_QUEUE_NAME - suffix.str().size()) + suffix.str();
+}
+
+bool isValidQueueName(const string& name) {
+    if (name.empty() || name.size() > MAX_QUEUE_NAME) {
+        return false;
+    }
+
+    for (char c : name) {
+        if (c == '\\' || c == '"' || isspace((unsigned char)c) || iscntrl((unsigned char)c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void setQueueNamespace(const string& name) {
+    currentNamespace() = name;
+}
+
+const string& queueNamespace() {
+    return currentNamespace();
+}
+
+string queueObjectName(const string& base) {
+    return currentNamespace().empty() ? base : base + "@" + currentNamespace();
+}
+
+HANDLE createMutex(const string& name) {
+    HANDLE hMutex = CreateMutexA(NULL, FALSE, name.c_str());
     if (!hMutex) {
         printError("Failed to create mutex");
     }
     return hMutex;
 }
 
-HANDLE openMutex() {
-    HANDLE hMutex = OpenMutexA(MUTEX_ALL_ACCESS, FALSE, "QueueMutex");
+HANDLE openMutex(const string& name) {
+    HANDLE hMutex = OpenMutexA(MUTEX_ALL_ACCESS, FALSE, name.c_str());
     if (!hMutex) {
         printError("Failed to open mutex");
     }
@@ -58,7 +113,7 @@ vector<HANDLE> createReadyEvents(int nSenders) {
     vector<HANDLE> readyEvents;
 
     for (int i = 0; i < nSenders; ++i) {
-        string evName = "SenderReady_" + to_string(i);
+        string evName = queueObjectName("SenderReady_" + to_string(i));
         HANDLE ev = createEvent(evName, false);
         readyEvents.push_back(ev);
     }
@@ -67,7 +122,7 @@ vector<HANDLE> createReadyEvents(int nSenders) {
 }
 
 void signalSenderReady(int senderId) {
-    string evName = "SenderReady_" + to_string(senderId);
+    string evName = queueObjectName("SenderReady_" + to_string(senderId));
     HANDLE evReady = openEvent(evName);
 
     if (evReady) {
@@ -77,36 +132,62 @@ void signalSenderReady(int senderId) {
     }
 }
 
-vector<PROCESS_INFORMATION> startAllSenders(const string& filename, int nSenders) {
-    vector<PROCESS_INFORMATION> processes;
+bool isProcessAlive(DWORD pid) {
+    if (pid == 0) {
+        return false;
+    }
 
-    for (int i = 0; i < nSenders; ++i) {
-        char exePath[MAX_PATH];
-        GetModuleFileNameA(NULL, exePath, MAX_PATH);
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!hProcess) {
+        return false;
+    }
 
-        string cmd = string(exePath) + " sender " + filename + " " + to_string(i);
+    DWORD exitCode = 0;
+    bool alive = GetExitCodeProcess(hProcess, &exitCode) && exitCode == STILL_ACTIVE;
+    CloseHandle(hProcess);
+    return alive;
+}
 
-        STARTUPINFOA si = { sizeof(si) };
+bool startSelfProcess(const string& args, DWORD creationFlags, PROCESS_INFORMATION& pi, const string& description) {
+    char exePath[MAX_PATH];
+    GetModuleFileNameA(NULL, exePath, MAX_PATH);
+
+    string cmd = string(exePath) + " " + args;
+    if (!queueNamespace().empty()) {
+        cmd += " --queue " + queueNamespace();
+    }
+
+    STARTUPINFOA si = { sizeof(si) };
+
+    BOOL success = CreateProcessA(
+        NULL,
+        (LPSTR)cmd.c_str(),
+        NULL, NULL,
+        FALSE,
+        creationFlags,
+        NULL, NULL,
+        &si, &pi
+    );
+
+    if (!success) {
+        printError("Failed to start " + description);
+        cout << "Command was: " << cmd << "\n";
+    }
+
+    return success;
+}
+
+vector<ChildProcess> startAllSenders(const string& filename, int nSenders, bool suspended) {
+    vector<ChildProcess> processes;
+
+    for (int i = 0; i < nSenders; ++i) {
         PROCESS_INFORMATION pi;
 
-        BOOL success = CreateProcessA(
-            NULL,
-            (LPSTR)cmd.c_str(),
-            NULL, NULL,
-            FALSE,
-            CREATE_NEW_CONSOLE,
-            NULL, NULL,
-            &si, &pi
-        );
-
-        if (success) {
-            processes.push_back(pi);
+        DWORD flags = CREATE_NEW_CONSOLE | (suspended ? CREATE_SUSPENDED : 0);
+        if (startSelfProcess("sender " + filename + " " + to_string(i), flags, pi, "sender #" + to_string(i))) {
+            processes.push_back({ i, pi });
             cout << "Started sender #" << i << " with PID: " << pi.dwProcessId << "\n";
         }
-        else {
-            printError("Failed to start sender #" + to_string(i));
-            cout << "Command was: " << cmd << "\n";
-        }
     }
 
     return processes;
@@ -126,7 +207,7 @@ void waitForSendersReady(const vector<HANDLE>& readyEvents) {
         GetModuleFileNameA(NULL, exePath, MAX_PATH);
 
         for (size_t i = 0; i < readyEvents.size(); ++i) {
-            cout << exePath << " sender <filename> " << i << "\n";
+            cout << exePath << " sender <filename> " << i << " --queue " << queueNamespace() << "\n";
         }
     }
     else if (waitResult == WAIT_FAILED) {
@@ -137,11 +218,11 @@ void waitForSendersReady(const vector<HANDLE>& readyEvents) {
     }
 }
 
-void terminateAllSenders(vector<PROCESS_INFORMATION>& processes) {
-    for (auto& pi : processes) {
-        TerminateProcess(pi.hProcess, 0);
-        WaitForSingleObject(pi.hProcess, 1000);
-        CloseHandle(pi.hProcess);
-        CloseHandle(pi.hThread);
+void terminateAllSenders(vector<ChildProcess>& processes) {
+    for (auto& process : processes) {
+        TerminateProcess(process.pi.hProcess, 0);
+        WaitForSingleObject(process.pi.hProcess, 1000);
+        CloseHandle(process.pi.hProcess);
+        CloseHandle(process.pi.hThread);
     }
 }
\ No newline at end of file
@@ -14,16 +14,32 @@ bool waitForObject(HANDLE handle, const string& context, DWORD timeout = 5000);
 void cleanupHandles(const vector<HANDLE>& handles);
 
 
-HANDLE createMutex();
-HANDLE openMutex();
+const size_t MAX_QUEUE_NAME = 64;
+
+string queueNameFromPath(const string& filename);
+bool isValidQueueName(const string& name);
+void setQueueNamespace(const string& name);
+const string& queueNamespace();
+string queueObjectName(const string& base);
+
+
+HANDLE createMutex(const string& name = "QueueMutex");
+HANDLE openMutex(const string& name = "QueueMutex");
 HANDLE createEvent(const string& name, bool initialState, bool manualReset = true);
 HANDLE openEvent(const string& name);
 vector<HANDLE> createReadyEvents(int nSenders);
 void signalSenderReady(int senderId);
 
 
-vector<PROCESS_INFORMATION> startAllSenders(const string& filename, int nSenders);
+struct ChildProcess {
+    int id;
+    PROCESS_INFORMATION pi;
+};
+
+bool isProcessAlive(DWORD pid);
+bool startSelfProcess(const string& args, DWORD creationFlags, PROCESS_INFORMATION& pi, const string& description);
+vector<ChildProcess> startAllSenders(const string& filename, int nSenders, bool suspended = false);
 void waitForSendersReady(const vector<HANDLE>& readyEvents);
-void terminateAllSenders(vector<PROCESS_INFORMATION>& processes);
+void terminateAllSenders(vector<ChildProcess>& processes);
 
 #endif
\ No newline at end of file
@@ -5,6 +5,21 @@
 #include <chrono>
 #include "queue_file.h"
 #include "sync_utils.h"
+#include "broadcast.h"
+#include "sender.h"
+#include "receiver.h"
+#include "reply_channel.h"
+#include "message_index.h"
+#include "batch_io.h"
+#include "drain.h"
+#include "placement.h"
+#include "overflow.h"
+#include "queue_registry.h"
+#include "transaction.h"
+#include "timing_wheel.h"
+#include "async_queue.h"
+#include "pingpong.h"
+#include <sstream>
 
 using namespace std;
 
@@ -41,11 +56,13 @@ protected:
 };
 
 TEST(QueueHeaderTest, StructureSizeAndAlignment) {
-    EXPECT_EQ(sizeof(QueueHeader), 16);
+    EXPECT_EQ(sizeof(QueueHeader), 40);
     EXPECT_EQ(offsetof(QueueHeader, capacity), 0);
     EXPECT_EQ(offsetof(QueueHeader, head), 4);
     EXPECT_EQ(offsetof(QueueHeader, tail), 8);
     EXPECT_EQ(offsetof(QueueHeader, count), 12);
+    EXPECT_EQ(offsetof(QueueHeader, overflowPolicy), 16);
+    EXPECT_EQ(offsetof(QueueHeader, rejected), 36);
 }
 
 TEST(ConstantsTest, MessageSize) {
@@ -178,6 +195,177 @@ TEST_F(QueueFileTest, OverwriteMessage) {
     EXPECT_STREQ(buffer, "Second");
 }
 
+TEST_F(QueueFileTest, WriteAndReadMessageMeta) {
+    const int capacity = 3;
+    initializeQueueFile(hFile, capacity);
+
+    MessageMeta written = {7, 42, 3};
+    EXPECT_TRUE(writeMessage(hFile, {capacity, 0, 0, 0}, 2, "Request", written));
+
+    char buffer[MSG_SIZE + 1];
+    MessageMeta read;
+    EXPECT_TRUE(readMessage(hFile, {capacity, 0, 0, 0}, 2, buffer, &read));
+    EXPECT_STREQ(buffer, "Request");
+    EXPECT_EQ(read.senderId, 7);
+    EXPECT_EQ(read.correlationId, 42);
+    EXPECT_EQ(read.tag, 3);
+}
+
+TEST_F(QueueFileTest, BroadcastDeliversToEverySubscriber) {
+    const int capacity = 3;
+    initializeQueueFile(hFile, capacity);
+    QueueHeader h = {capacity, 0, 0, 0};
+    ASSERT_TRUE(initializeBroadcast(hFile, h, false));
+
+    BroadcastSection section;
+    ASSERT_TRUE(readBroadcastSection(hFile, h, section));
+    EXPECT_TRUE(isBroadcastQueue(section));
+    section.subscribers[0].state = SUBSCRIBER_ACTIVE;
+    section.subscribers[1].state = SUBSCRIBER_ACTIVE;
+
+    EXPECT_TRUE(publishMessage(hFile, h, section, "Fanout"));
+    EXPECT_EQ(h.count, 1);
+
+    char buffer[MSG_SIZE + 1];
+    EXPECT_TRUE(receiveBroadcast(hFile, h, section, 0, buffer));
+    EXPECT_STREQ(buffer, "Fanout");
+    EXPECT_EQ(h.count, 1);
+
+    EXPECT_TRUE(receiveBroadcast(hFile, h, section, 1, buffer));
+    EXPECT_STREQ(buffer, "Fanout");
+    EXPECT_EQ(h.count, 0);
+    EXPECT_EQ(h.head, h.tail);
+
+    EXPECT_FALSE(receiveBroadcast(hFile, h, section, 1, buffer));
+}
+
+TEST_F(QueueFileTest, BroadcastSlowestSubscriberBlocksReclaim) {
+    const int capacity = 2;
+    initializeQueueFile(hFile, capacity);
+    QueueHeader h = {capacity, 0, 0, 0};
+    ASSERT_TRUE(initializeBroadcast(hFile, h, false));
+
+    BroadcastSection section;
+    ASSERT_TRUE(readBroadcastSection(hFile, h, section));
+    section.subscribers[0].state = SUBSCRIBER_ACTIVE;
+    section.subscribers[1].state = SUBSCRIBER_ACTIVE;
+
+    EXPECT_TRUE(publishMessage(hFile, h, section, "A"));
+    EXPECT_TRUE(publishMessage(hFile, h, section, "B"));
+
+    char buffer[MSG_SIZE + 1];
+    EXPECT_TRUE(receiveBroadcast(hFile, h, section, 0, buffer));
+    EXPECT_TRUE(receiveBroadcast(hFile, h, section, 0, buffer));
+    EXPECT_EQ(h.count, capacity);
+    EXPECT_FALSE(publishMessage(hFile, h, section, "C"));
+
+    EXPECT_TRUE(receiveBroadcast(hFile, h, section, 1, buffer));
+    EXPECT_STREQ(buffer, "A");
+    EXPECT_TRUE(publishMessage(hFile, h, section, "C"));
+    EXPECT_TRUE(receiveBroadcast(hFile, h, section, 1, buffer));
+    EXPECT_STREQ(buffer, "B");
+    EXPECT_TRUE(receiveBroadcast(hFile, h, section, 0, buffer));
+    EXPECT_STREQ(buffer, "C");
+}
+
+TEST_F(QueueFileTest, BroadcastDropsLaggingSubscriber) {
+    const int capacity = 2;
+    initializeQueueFile(hFile, capacity);
+    QueueHeader h = {capacity, 0, 0, 0};
+    ASSERT_TRUE(initializeBroadcast(hFile, h, true));
+
+    BroadcastSection section;
+    ASSERT_TRUE(readBroadcastSection(hFile, h, section));
+    section.subscribers[0].state = SUBSCRIBER_ACTIVE;
+    section.subscribers[1].state = SUBSCRIBER_ACTIVE;
+
+    char buffer[MSG_SIZE + 1];
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(publishMessage(hFile, h, section, "Msg" + to_string(i)));
+        EXPECT_TRUE(receiveBroadcast(hFile, h, section, 0, buffer));
+    }
+
+    EXPECT_EQ(section.subscribers[1].state, SUBSCRIBER_DROPPED);
+    EXPECT_EQ(section.droppedCount, 1);
+    EXPECT_EQ(h.count, 0);
+    EXPECT_STREQ(buffer, "Msg2");
+
+    BroadcastSection stored;
+    ASSERT_TRUE(readBroadcastSection(hFile, h, stored));
+    EXPECT_EQ(stored.subscribers[1].state, SUBSCRIBER_DROPPED);
+}
+
+TEST_F(QueueFileTest, OrdinaryQueueIsNotBroadcast) {
+    const int capacity = 4;
+    initializeQueueFile(hFile, capacity);
+
+    BroadcastSection section;
+    EXPECT_TRUE(readBroadcastSection(hFile, {capacity, 0, 0, 0}, section));
+    EXPECT_FALSE(isBroadcastQueue(section));
+}
+
+TEST_F(QueueFileTest, InitializeQueueFileRejectsZeroCapacity) {
+    EXPECT_FALSE(initializeQueueFile(hFile, 0));
+    EXPECT_FALSE(initializeQueueFile(hFile, -5));
+}
+
+TEST_F(QueueFileTest, SlotOffsetsBeyondTwoGigabytes) {
+    QueueHeader h = { 60000001, 0, 0, 0 };
+    EXPECT_EQ(slotOffset(h, 60000000), (LONGLONG)sizeof(QueueHeader) + 60000000LL * SLOT_SIZE);
+    EXPECT_GT(wheelSectionEnd(h), slotOffset(h, 60000000));
+}
+
+TEST_F(QueueFileTest, HugeQueueInitializesSparsely) {
+    const int capacity = 20000000;
+    DWORD started = GetTickCount();
+    ASSERT_TRUE(initializeQueueFile(hFile, capacity));
+    EXPECT_LT(GetTickCount() - started, 1000u);
+
+    QueueHeader h;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    LARGE_INTEGER size;
+    ASSERT_TRUE(GetFileSizeEx(hFile, &size));
+    EXPECT_EQ(size.QuadPart, slotOffset(h, capacity));
+
+    started = GetTickCount();
+    WheelState state = {};
+    ASSERT_TRUE(writeWheelState(hFile, h, state));
+    EXPECT_LT(GetTickCount() - started, 1000u);
+
+    BY_HANDLE_FILE_INFORMATION info;
+    ASSERT_TRUE(GetFileInformationByHandle(hFile, &info));
+    EXPECT_NE(info.dwFileAttributes & FILE_ATTRIBUTE_SPARSE_FILE, 0u);
+
+    ASSERT_TRUE(writeMessage(hFile, h, capacity - 1, "Last", { 3, 0, 0 }));
+    char buffer[MSG_SIZE + 1] = { 0 };
+    MessageMeta meta;
+    ASSERT_TRUE(readMessage(hFile, h, capacity - 1, buffer, &meta));
+    EXPECT_STREQ(buffer, "Last");
+    EXPECT_EQ(meta.senderId, 3);
+
+    SlotHeader slot;
+    ASSERT_TRUE(readSlot(hFile, h, capacity / 2, slot, buffer));
+    EXPECT_EQ(slot.state, SLOT_EMPTY);
+}
+
+TEST_F(QueueFileTest, ReinitializeDiscardsOldMessages) {
+    ASSERT_TRUE(initializeQueueFile(hFile, 4));
+    QueueHeader h;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(writeMessage(hFile, h, 1, "Stale"));
+    h.count = 2;
+    ASSERT_TRUE(writeQueueHeader(hFile, h));
+
+    ASSERT_TRUE(initializeQueueFile(hFile, 4));
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    EXPECT_EQ(h.count, 0);
+
+    SlotHeader slot;
+    char buffer[MSG_SIZE + 1] = { 0 };
+    ASSERT_TRUE(readSlot(hFile, h, 1, slot, buffer));
+    EXPECT_EQ(slot.state, SLOT_EMPTY);
+}
+
 TEST_F(SyncUtilsTest, CreateAndOpenMutex) {
     HANDLE mutex = createMutex();
     EXPECT_NE(mutex, nullptr);
@@ -404,6 +592,878 @@ TEST(BoundaryTest, MessageWithSpecialCharacters) {
     DeleteFileA(filename.c_str());
 }
 
+TEST(RequestReplyTest, EnqueueBlocksWhenFullAndDequeueSkipsSpuriousWakeup) {
+    string filename = "full_test_" + to_string(GetTickCount()) + ".bin";
+    HANDLE hFile = openFile(filename, true);
+    ASSERT_NE(hFile, INVALID_HANDLE_VALUE);
+    ASSERT_TRUE(initializeQueueFile(hFile, 1));
+
+    HANDLE hMutex = CreateMutexA(NULL, FALSE, NULL);
+    HANDLE evNotEmpty = CreateEventA(NULL, TRUE, FALSE, NULL);
+    HANDLE evNotFull = CreateEventA(NULL, TRUE, TRUE, NULL);
+
+    EXPECT_EQ(enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, "First", { 1, 0, 0 }), ENQUEUE_OK);
+    EXPECT_EQ(enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, "Second", { 1, 0, 0 }, 100), ENQUEUE_FULL);
+
+    char buffer[MSG_SIZE + 1];
+    EXPECT_TRUE(dequeueMessage(hFile, hMutex, evNotEmpty, evNotFull, buffer, NULL, 100));
+    EXPECT_STREQ(buffer, "First");
+
+    SetEvent(evNotEmpty);
+    EXPECT_FALSE(dequeueMessage(hFile, hMutex, evNotEmpty, evNotFull, buffer, NULL, 100));
+
+    QueueHeader h;
+    EXPECT_TRUE(readQueueHeader(hFile, h));
+    EXPECT_EQ(h.count, 0);
+
+    cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+    DeleteFileA(filename.c_str());
+}
+
+TEST(RequestReplyTest, CallReceivesMatchingReply) {
+    string filename = "rpc_test_" + to_string(GetTickCount()) + ".bin";
+    HANDLE hFile = openFile(filename, true);
+    ASSERT_NE(hFile, INVALID_HANDLE_VALUE);
+    ASSERT_TRUE(initializeQueueFile(hFile, 4));
+
+    HANDLE hMutex = CreateMutexA(NULL, FALSE, NULL);
+    HANDLE evNotEmpty = CreateEventA(NULL, TRUE, FALSE, NULL);
+    HANDLE evNotFull = CreateEventA(NULL, TRUE, TRUE, NULL);
+
+    ReplyChannel channel;
+    ASSERT_TRUE(createReplyChannel(filename, 5, channel));
+    ASSERT_TRUE(sendReply(channel, { 5, 1, 0 }, "stale"));
+
+    thread server([&]() {
+        map<int, ReplyChannel> channels;
+        serveRequests(hFile, hMutex, evNotEmpty, evNotFull, filename, channels, 1);
+        for (auto& entry : channels) {
+            closeReplyChannel(entry.second);
+        }
+    });
+
+    char reply[MSG_SIZE + 1] = { 0 };
+    EXPECT_TRUE(callRequest(hFile, hMutex, evNotFull, evNotEmpty, channel, { 5, 2, 0 }, "echo me", reply));
+    EXPECT_STREQ(reply, "echo me");
+    server.join();
+
+    closeReplyChannel(channel);
+    cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+    DeleteFileA(filename.c_str());
+    DeleteFileA(replyFileName(filename, 5).c_str());
+}
+
+class SelectiveReceiveTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        filename = "selective_test_" + to_string(GetTickCount()) + ".bin";
+        hFile = openFile(filename, true);
+        ASSERT_NE(hFile, INVALID_HANDLE_VALUE);
+        ASSERT_TRUE(initializeQueueFile(hFile, 4));
+
+        hMutex = CreateMutexA(NULL, FALSE, NULL);
+        evNotEmpty = CreateEventA(NULL, TRUE, FALSE, NULL);
+        evNotFull = CreateEventA(NULL, TRUE, TRUE, NULL);
+    }
+
+    void TearDown() override {
+        cleanupHandles({ hFile, hMutex, evNotEmpty, evNotFull });
+        DeleteFileA(filename.c_str());
+    }
+
+    bool send(const string& msg, int senderId, int tag) {
+        return enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, msg, { senderId, 0, tag }, 100) == ENQUEUE_OK;
+    }
+
+    string receive(const MessageFilter& filter) {
+        char buffer[MSG_SIZE + 1] = { 0 };
+        if (!dequeueMessage(hFile, hMutex, evNotEmpty, evNotFull, buffer, NULL, 100, filter)) {
+            return "<none>";
+        }
+        return buffer;
+    }
+
+    string filename;
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    HANDLE hMutex = NULL;
+    HANDLE evNotEmpty = NULL;
+    HANDLE evNotFull = NULL;
+};
+
+TEST_F(SelectiveReceiveTest, ReadFromSenderSkipsOtherSenders) {
+    EXPECT_TRUE(send("A1", 1, 0));
+    EXPECT_TRUE(send("B1", 2, 0));
+    EXPECT_TRUE(send("A2", 1, 0));
+    EXPECT_TRUE(send("B2", 2, 0));
+
+    EXPECT_EQ(receive({ MATCH_SENDER, 2 }), "B1");
+    EXPECT_EQ(receive({ MATCH_SENDER, 2 }), "B2");
+    EXPECT_EQ(receive({ MATCH_SENDER, 2 }), "<none>");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "A1");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "A2");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "<none>");
+
+    QueueHeader h;
+    MessageIndex index;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(readMessageIndex(hFile, h, index));
+    EXPECT_EQ(h.count, 0);
+    EXPECT_EQ(index.live, 0);
+    EXPECT_EQ(index.holes, 0);
+}
+
+TEST_F(SelectiveReceiveTest, ConsumedSlotIsReclaimedWhenHeadPassesIt) {
+    EXPECT_TRUE(send("Plain", 1, 0));
+    EXPECT_TRUE(send("Urgent", 1, 7));
+    EXPECT_TRUE(send("Plain2", 2, 0));
+
+    EXPECT_EQ(receive({ MATCH_TAG, 7 }), "Urgent");
+
+    QueueHeader h;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    EXPECT_EQ(h.count, 3);
+
+    EXPECT_EQ(receive({ MATCH_SENDER, 1 }), "Plain");
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    EXPECT_EQ(h.count, 1);
+    EXPECT_EQ(h.head, 2);
+
+    EXPECT_EQ(receive({ MATCH_SENDER, 1 }), "<none>");
+    EXPECT_EQ(receive({ MATCH_TAG, 0 }), "Plain2");
+}
+
+TEST_F(SelectiveReceiveTest, FilterEventsAreReopenedAfterClose) {
+    EXPECT_EQ(receive({ MATCH_TAG, 7 }), "<none>");
+    HANDLE cached = filterEvent({ MATCH_TAG, 7 });
+    ASSERT_NE(cached, (HANDLE)NULL);
+    EXPECT_EQ(filterEvent({ MATCH_TAG, 7 }), cached);
+
+    closeFilterEvents();
+
+    EXPECT_TRUE(send("Urgent", 1, 7));
+    EXPECT_EQ(receive({ MATCH_TAG, 7 }), "Urgent");
+    closeFilterEvents();
+}
+
+TEST_F(SelectiveReceiveTest, IndexSurvivesWrapAround) {
+    for (int round = 0; round < 3; ++round) {
+        EXPECT_TRUE(send("X" + to_string(round), 3, 1));
+        EXPECT_TRUE(send("Y" + to_string(round), 4, 2));
+        EXPECT_TRUE(send("Z" + to_string(round), 3, 2));
+
+        EXPECT_EQ(receive({ MATCH_TAG, 2 }), "Y" + to_string(round));
+        EXPECT_EQ(receive({ MATCH_SENDER, 3 }), "X" + to_string(round));
+        EXPECT_EQ(receive({ MATCH_SENDER, 3 }), "Z" + to_string(round));
+    }
+
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "<none>");
+}
+
+class BatchIoTest : public SelectiveReceiveTest {
+protected:
+    int sendBatch(const vector<string>& messages, int senderId) {
+        return enqueueBatch(hFile, hMutex, evNotFull, evNotEmpty, messages, { senderId, 0, 0 }, true, 100);
+    }
+};
+
+TEST_F(BatchIoTest, BatchWrapsAroundAndLinksIndex) {
+    EXPECT_TRUE(send("First", 1, 0));
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "First");
+
+    EXPECT_EQ(sendBatch({ "B1", "B2", "B3", "B4", "B5" }, 3), 4);
+
+    QueueHeader h;
+    MessageIndex index;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(readMessageIndex(hFile, h, index));
+    EXPECT_EQ(h.count, 4);
+    EXPECT_EQ(h.tail, 1);
+    EXPECT_EQ(index.live, 4);
+
+    EXPECT_EQ(receive({ MATCH_SENDER, 3 }), "B1");
+    EXPECT_EQ(receive({ MATCH_SENDER, 3 }), "B2");
+    EXPECT_EQ(receive({ MATCH_SENDER, 3 }), "B3");
+    EXPECT_EQ(receive({ MATCH_SENDER, 3 }), "B4");
+    EXPECT_EQ(receive({ MATCH_SENDER, 3 }), "<none>");
+}
+
+TEST_F(BatchIoTest, DequeueBatchSkipsConsumedSlots) {
+    EXPECT_TRUE(send("Plain", 1, 0));
+    EXPECT_TRUE(send("Urgent", 1, 7));
+    EXPECT_TRUE(send("Plain2", 2, 0));
+    EXPECT_EQ(receive({ MATCH_TAG, 7 }), "Urgent");
+
+    vector<string> messages;
+    vector<MessageMeta> metas;
+    EXPECT_EQ(dequeueBatch(hFile, hMutex, evNotEmpty, evNotFull, 10, messages, &metas, 100), 2);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0], "Plain");
+    EXPECT_EQ(messages[1], "Plain2");
+    EXPECT_EQ(metas[1].senderId, 2);
+
+    QueueHeader h;
+    MessageIndex index;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(readMessageIndex(hFile, h, index));
+    EXPECT_EQ(h.count, 0);
+    EXPECT_EQ(index.live, 0);
+    EXPECT_EQ(index.holes, 0);
+    EXPECT_EQ(receive({ MATCH_SENDER, 1 }), "<none>");
+}
+
+TEST_F(BatchIoTest, DequeueBatchReleasesHolesAfterLastTaken) {
+    EXPECT_TRUE(send("Plain", 1, 0));
+    EXPECT_TRUE(send("Urgent", 1, 7));
+    EXPECT_TRUE(send("Plain2", 2, 0));
+    EXPECT_EQ(receive({ MATCH_TAG, 7 }), "Urgent");
+
+    vector<string> messages;
+    EXPECT_EQ(dequeueBatch(hFile, hMutex, evNotEmpty, evNotFull, 1, messages, NULL, 100), 1);
+    EXPECT_EQ(messages[0], "Plain");
+
+    QueueHeader h;
+    MessageIndex index;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(readMessageIndex(hFile, h, index));
+    EXPECT_EQ(h.head, 2);
+    EXPECT_EQ(h.count, 1);
+    EXPECT_EQ(index.holes, 0);
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Plain2");
+}
+
+TEST_F(BatchIoTest, DrainStopsAtLimitAndWhenIdle) {
+    EXPECT_EQ(sendBatch({ "M1", "M2", "M3" }, 1), 3);
+
+    ostringstream first;
+    DrainStats stats = drainQueue(hFile, hMutex, evNotEmpty, evNotFull, first, 2, 50);
+    EXPECT_EQ(stats.messages, 2);
+    EXPECT_EQ(first.str(), "M1\nM2\n");
+
+    EXPECT_EQ(sendBatch({ "M4", "M5", "M6" }, 1), 3);
+
+    ostringstream rest;
+    stats = drainQueue(hFile, hMutex, evNotEmpty, evNotFull, rest, 0, 50);
+    EXPECT_EQ(stats.messages, 4);
+    EXPECT_EQ(rest.str(), "M3\nM4\nM5\nM6\n");
+}
+
+class SlowStringBuf : public stringbuf {
+protected:
+    streamsize xsputn(const char* s, streamsize n) override {
+        this_thread::sleep_for(chrono::milliseconds(5));
+        return stringbuf::xsputn(s, n);
+    }
+};
+
+TEST_F(BatchIoTest, DrainStagingIsBoundedBySlowWriter) {
+    const int total = 200;
+    const size_t limit = 32;
+
+    thread producer([this]() {
+        for (int i = 0; i < total; ++i) {
+            enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, "M" + to_string(i), { 1, 0, 0 }, 2000);
+        }
+    });
+
+    SlowStringBuf buffer;
+    ostream slow(&buffer);
+    DrainStats stats = drainQueue(hFile, hMutex, evNotEmpty, evNotFull, slow, total, 2000, limit);
+    producer.join();
+
+    EXPECT_EQ(stats.messages, total);
+    EXPECT_LT(stats.peakStaged, limit + 4 * (MSG_SIZE + 1));
+
+    istringstream lines(buffer.str());
+    string line;
+    int expected = 0;
+    while (getline(lines, line)) {
+        EXPECT_EQ(line, "M" + to_string(expected++));
+    }
+    EXPECT_EQ(expected, total);
+}
+
+class OverflowTest : public SelectiveReceiveTest {
+protected:
+    void setPolicy(int policy, int blockTimeout = 0) {
+        QueueHeader h;
+        ASSERT_TRUE(readQueueHeader(hFile, h));
+        h.overflowPolicy = policy;
+        h.blockTimeout = blockTimeout;
+        ASSERT_TRUE(writeQueueHeader(hFile, h));
+    }
+
+    QueueHeader header() {
+        QueueHeader h = {};
+        EXPECT_TRUE(readQueueHeader(hFile, h));
+        return h;
+    }
+};
+
+TEST_F(OverflowTest, DropOldestOverwritesUnreadMessages) {
+    setPolicy(OVERFLOW_DROP_OLDEST);
+
+    for (int i = 1; i <= 6; ++i) {
+        EXPECT_TRUE(send("M" + to_string(i), 1, 0));
+    }
+
+    EXPECT_EQ(header().count, 4);
+    EXPECT_EQ(header().droppedOldest, 2);
+    EXPECT_EQ(receive({ MATCH_SENDER, 1 }), "M3");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "M4");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "M5");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "M6");
+}
+
+TEST_F(OverflowTest, DropNewestAndFailCountLostMessages) {
+    setPolicy(OVERFLOW_DROP_NEWEST);
+    for (int i = 1; i <= 4; ++i) {
+        EXPECT_TRUE(send("M" + to_string(i), 1, 0));
+    }
+    EXPECT_EQ(enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, "M5", { 1, 0, 0 }, 100), ENQUEUE_DROPPED);
+    EXPECT_EQ(header().droppedNewest, 1);
+
+    int dropped = 0;
+    EXPECT_EQ(enqueueBatch(hFile, hMutex, evNotFull, evNotEmpty, { "B1", "B2" }, { 1, 0, 0 }, false, 100, &dropped), 0);
+    EXPECT_EQ(dropped, 2);
+    EXPECT_EQ(header().droppedNewest, 3);
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "M1");
+
+    setPolicy(OVERFLOW_FAIL);
+    EXPECT_TRUE(send("M6", 1, 0));
+    EXPECT_FALSE(send("M7", 1, 0));
+    EXPECT_EQ(header().rejected, 1);
+    EXPECT_EQ(header().count, 4);
+}
+
+TEST_F(OverflowTest, DropOldestWaitsBehindOpenTransaction) {
+    setPolicy(OVERFLOW_DROP_OLDEST);
+
+    Transaction txn;
+    ASSERT_TRUE(beginTransaction(hFile, hMutex, evNotFull, 1, txn, 100));
+    ASSERT_TRUE(stageMessage(hFile, txn, "Reserved", { 1, 0, 0 }));
+    for (int i = 1; i <= 3; ++i) {
+        EXPECT_TRUE(send("M" + to_string(i), 2, 0));
+    }
+
+    EXPECT_EQ(enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, "Late", { 2, 0, 0 }, 100), ENQUEUE_FULL);
+    EXPECT_EQ(header().droppedOldest, 0);
+    EXPECT_EQ(header().timedOut, 1);
+
+    ASSERT_TRUE(commitTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn));
+    EXPECT_TRUE(send("Late", 2, 0));
+    EXPECT_EQ(header().droppedOldest, 1);
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "M1");
+}
+
+TEST_F(OverflowTest, BlockUsesDeadlineFromHeader) {
+    setPolicy(OVERFLOW_BLOCK, 50);
+    for (int i = 1; i <= 4; ++i) {
+        EXPECT_TRUE(send("M" + to_string(i), 1, 0));
+    }
+
+    DWORD started = GetTickCount();
+    EXPECT_EQ(enqueueMessage(hFile, hMutex, evNotFull, evNotEmpty, "Late", { 1, 0, 0 }, 5000), ENQUEUE_FULL);
+    EXPECT_LT(GetTickCount() - started, 2000u);
+    EXPECT_EQ(header().timedOut, 1);
+}
+
+class TransactionTest : public SelectiveReceiveTest {
+protected:
+    bool begin(Transaction& txn, int size) {
+        return beginTransaction(hFile, hMutex, evNotFull, size, txn, 100);
+    }
+
+    bool stage(Transaction& txn, const string& msg, int senderId) {
+        return stageMessage(hFile, txn, msg, { senderId, 0, 0 });
+    }
+};
+
+TEST_F(TransactionTest, CommittedMessagesBecomeVisibleTogether) {
+    Transaction txn;
+    EXPECT_TRUE(send("Before", 1, 0));
+    ASSERT_TRUE(begin(txn, 2));
+    EXPECT_TRUE(stage(txn, "Part1", 1));
+    EXPECT_TRUE(send("Other", 2, 0));
+    EXPECT_TRUE(stage(txn, "Part2", 1));
+    EXPECT_FALSE(stage(txn, "Part3", 1));
+
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Before");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "<none>");
+    EXPECT_EQ(receive({ MATCH_SENDER, 1 }), "<none>");
+
+    ASSERT_TRUE(commitTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn));
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Part1");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Part2");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Other");
+}
+
+TEST_F(TransactionTest, SelectiveReadAfterCommitKeepsRingOrder) {
+    Transaction txn;
+    EXPECT_TRUE(send("Before", 1, 0));
+    ASSERT_TRUE(begin(txn, 2));
+    EXPECT_TRUE(stage(txn, "Part1", 1));
+    EXPECT_TRUE(stage(txn, "Part2", 1));
+    EXPECT_TRUE(send("Other", 2, 0));
+    ASSERT_TRUE(commitTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn));
+
+    EXPECT_EQ(receive({ MATCH_TAG, 0 }), "Before");
+    EXPECT_EQ(receive({ MATCH_TAG, 0 }), "Part1");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Part2");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Other");
+
+    EXPECT_TRUE(send("After", 3, 0));
+    EXPECT_EQ(receive({ MATCH_TAG, 0 }), "After");
+    EXPECT_EQ(receive({ MATCH_TAG, 0 }), "<none>");
+
+    QueueHeader h;
+    MessageIndex index;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(readMessageIndex(hFile, h, index));
+    EXPECT_EQ(h.count, 0);
+    EXPECT_EQ(index.live, 0);
+    EXPECT_EQ(index.holes, 0);
+}
+
+TEST_F(TransactionTest, SizeIsLimitedToOneBatch) {
+    ASSERT_TRUE(initializeQueueFile(hFile, MAX_BATCH * 2));
+
+    Transaction txn;
+    EXPECT_FALSE(begin(txn, MAX_BATCH + 1));
+    ASSERT_TRUE(begin(txn, MAX_BATCH));
+    EXPECT_EQ(txn.slots.size(), (size_t)MAX_BATCH * SLOT_SIZE);
+    EXPECT_TRUE(abortTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn));
+}
+
+TEST_F(TransactionTest, AbortAndPartialCommitReleaseSlots) {
+    Transaction txn;
+    ASSERT_TRUE(begin(txn, 3));
+    EXPECT_TRUE(stage(txn, "Only", 1));
+    ASSERT_TRUE(commitTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn));
+    EXPECT_EQ(receive({ MATCH_SENDER, 1 }), "Only");
+
+    ASSERT_TRUE(begin(txn, 4));
+    EXPECT_FALSE(begin(txn, 1));
+    ASSERT_TRUE(abortTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn));
+    EXPECT_FALSE(abortTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn));
+
+    EXPECT_TRUE(send("After", 2, 0));
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "After");
+
+    QueueHeader h;
+    MessageIndex index;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(readMessageIndex(hFile, h, index));
+    EXPECT_EQ(h.count, 0);
+    EXPECT_EQ(index.holes, 0);
+}
+
+TEST_F(TransactionTest, ReservationOfExitedProcessIsReleased) {
+    Transaction txn;
+    ASSERT_TRUE(begin(txn, 2));
+    EXPECT_TRUE(stage(txn, "Lost", 1));
+    EXPECT_TRUE(send("Kept", 2, 0));
+
+    QueueHeader h;
+    TransactionTable table;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(readTransactionTable(hFile, h, table));
+    table.entries[txn.entry].ownerPid = 0;
+    ASSERT_TRUE(writeTransactionTable(hFile, h, table));
+
+    vector<string> messages;
+    EXPECT_EQ(dequeueBatch(hFile, hMutex, evNotEmpty, evNotFull, 10, messages, NULL, 100), 1);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0], "Kept");
+    EXPECT_FALSE(commitTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn));
+
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    EXPECT_EQ(h.count, 0);
+}
+
+class TimingWheelTest : public SelectiveReceiveTest {
+protected:
+    bool sendLater(const string& msg, DWORD delay) {
+        return enqueueDelayed(hFile, hMutex, evNotEmpty, msg, { 1, 0, 0 }, delay);
+    }
+
+    string receiveWithin(DWORD timeout) {
+        char buffer[MSG_SIZE + 1] = { 0 };
+        if (!dequeueMessage(hFile, hMutex, evNotEmpty, evNotFull, buffer, NULL, timeout)) {
+            return "<none>";
+        }
+        return buffer;
+    }
+};
+
+TEST_F(TimingWheelTest, DelayedMessageWaitsForItsTime) {
+    DWORD started = GetTickCount();
+    ASSERT_TRUE(sendLater("Later", 80));
+    EXPECT_TRUE(send("Now", 2, 0));
+
+    EXPECT_EQ(receiveWithin(1000), "Now");
+    EXPECT_EQ(receiveWithin(1000), "Later");
+    EXPECT_GE(GetTickCount() - started, 80u);
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "<none>");
+}
+
+TEST_F(TimingWheelTest, DeliversInDueOrderAcrossLevels) {
+    ASSERT_TRUE(sendLater("Third", 700));
+    ASSERT_TRUE(sendLater("Second", 60));
+    ASSERT_TRUE(sendLater("First", 20));
+
+    EXPECT_EQ(receiveWithin(2000), "First");
+    EXPECT_EQ(receiveWithin(2000), "Second");
+    EXPECT_EQ(receiveWithin(2000), "Third");
+
+    QueueHeader h;
+    WheelState state;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(readWheelState(hFile, h, state));
+    EXPECT_EQ(state.pending, 0);
+    EXPECT_EQ(state.freeList, 1);
+}
+
+TEST_F(TimingWheelTest, DueMessagesWaitForSpaceInTheRing) {
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(send("Ready" + to_string(i), 2, 0));
+    }
+    ASSERT_TRUE(sendLater("Late", 10));
+    Sleep(50);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Ready" + to_string(i));
+    }
+    EXPECT_EQ(receive({ MATCH_SENDER, 1 }), "Late");
+}
+
+TEST_F(TimingWheelTest, BatchSendDoesNotOvertakeDueMessages) {
+    ASSERT_TRUE(sendLater("Due", 10));
+    Sleep(50);
+
+    EXPECT_EQ(enqueueBatch(hFile, hMutex, evNotFull, evNotEmpty, { "B1", "B2" }, { 2, 0, 0 }, false, 100), 2);
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "Due");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "B1");
+    EXPECT_EQ(receive({ MATCH_ANY, 0 }), "B2");
+}
+
+TEST_F(TimingWheelTest, WakesReadersOnlyForEarlierDeadlines) {
+    ASSERT_TRUE(sendLater("First", 60000));
+    EXPECT_EQ(WaitForSingleObject(evNotEmpty, 0), WAIT_OBJECT_0);
+    ResetEvent(evNotEmpty);
+
+    ASSERT_TRUE(sendLater("Later", 60000));
+    EXPECT_EQ(WaitForSingleObject(evNotEmpty, 0), WAIT_TIMEOUT);
+
+    ASSERT_TRUE(sendLater("Soon", 20));
+    EXPECT_EQ(WaitForSingleObject(evNotEmpty, 0), WAIT_OBJECT_0);
+    EXPECT_EQ(receiveWithin(1000), "Soon");
+}
+
+TEST_F(TimingWheelTest, EarlyWakeupsShareOneDeadline) {
+    DWORD started = GetTickCount();
+    EXPECT_TRUE(waitForMessages(evNotEmpty, NULL, started, 300, 150));
+    EXPECT_TRUE(waitForMessages(evNotEmpty, NULL, started, 300, 100));
+    EXPECT_FALSE(waitForMessages(evNotEmpty, NULL, started, 300, 1000));
+
+    DWORD elapsed = GetTickCount() - started;
+    EXPECT_GE(elapsed, 280u);
+    EXPECT_LT(elapsed, 450u);
+}
+
+TEST_F(TimingWheelTest, RejectsInvalidDelaysAndFullPool) {
+    EXPECT_FALSE(sendLater("Zero", 0));
+    EXPECT_FALSE(sendLater("Far", MAX_DELAY_MS + 1));
+
+    for (int i = 0; i < MAX_DELAYED; ++i) {
+        ASSERT_TRUE(sendLater("Wait", 60000));
+    }
+    EXPECT_FALSE(sendLater("Overflow", 60000));
+}
+
+static QueueTask produceMessages(AsyncQueue& queue, int senderId, int count) {
+    for (int i = 0; i < count; ++i) {
+        co_await queue.push(to_string(senderId) + ":" + to_string(i), { senderId, 0, 0 });
+    }
+}
+
+static QueueTask consumeMessages(AsyncQueue& queue, int count, vector<string>& received) {
+    string message;
+    for (int i = 0; i < count; ++i) {
+        if (co_await queue.pop(message)) {
+            received.push_back(message);
+        }
+    }
+}
+
+class AsyncQueueTest : public SelectiveReceiveTest {
+protected:
+    void SetUp() override {
+        SelectiveReceiveTest::SetUp();
+        queue.hFile = hFile;
+        queue.hMutex = hMutex;
+        queue.evNotEmpty = evNotEmpty;
+        queue.evNotFull = evNotFull;
+    }
+
+    void TearDown() override {
+        destroyQueueTasks(queue);
+        SelectiveReceiveTest::TearDown();
+    }
+
+    AsyncQueue queue;
+};
+
+TEST_F(AsyncQueueTest, ManyCoroutinesShareOneThread) {
+    vector<string> received;
+    for (int i = 0; i < 100; ++i) {
+        spawnQueueTask(queue, produceMessages(queue, i, 5));
+    }
+    for (int i = 0; i < 50; ++i) {
+        spawnQueueTask(queue, consumeMessages(queue, 10, received));
+    }
+
+    EXPECT_EQ(runQueueTasks(queue, 1000), 150);
+    ASSERT_EQ(received.size(), 500u);
+
+    vector<int> next(100, 0);
+    for (const string& message : received) {
+        int senderId = stoi(message.substr(0, message.find(':')));
+        EXPECT_EQ(message, to_string(senderId) + ":" + to_string(next[senderId]));
+        next[senderId]++;
+    }
+
+    QueueHeader h;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    EXPECT_EQ(h.count, 0);
+}
+
+TEST_F(AsyncQueueTest, PopIsResumedBySenderInAnotherThread) {
+    vector<string> received;
+    spawnQueueTask(queue, consumeMessages(queue, 2, received));
+
+    thread sender([this]() {
+        Sleep(50);
+        send("First", 1, 0);
+        Sleep(50);
+        send("Second", 1, 0);
+    });
+
+    EXPECT_EQ(runQueueTasks(queue, 2000), 1);
+    sender.join();
+
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[0], "First");
+    EXPECT_EQ(received[1], "Second");
+}
+
+TEST_F(AsyncQueueTest, IdleSchedulerKeepsSuspendedTasks) {
+    vector<string> received;
+    spawnQueueTask(queue, consumeMessages(queue, 1, received));
+
+    EXPECT_EQ(runQueueTasks(queue, 50), 0);
+    EXPECT_EQ(queue.poppers.size(), 1u);
+
+    ASSERT_TRUE(send("Late", 1, 0));
+    EXPECT_EQ(runQueueTasks(queue, 1000), 1);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], "Late");
+}
+
+TEST(FilterTest, ParseReadArguments) {
+    MessageFilter filter;
+    EXPECT_TRUE(parseFilter("", filter));
+    EXPECT_EQ(filter.kind, MATCH_ANY);
+
+    EXPECT_TRUE(parseFilter(" --from 3", filter));
+    EXPECT_EQ(filter.kind, MATCH_SENDER);
+    EXPECT_EQ(filter.value, 3);
+
+    EXPECT_TRUE(parseFilter("--tag 5", filter));
+    EXPECT_EQ(filter.kind, MATCH_TAG);
+    EXPECT_EQ(filter.value, 5);
+
+    EXPECT_FALSE(parseFilter("--tag", filter));
+    EXPECT_FALSE(parseFilter("--tag 999", filter));
+    EXPECT_FALSE(parseFilter("--sender 1", filter));
+}
+
+TEST(FilterTest, ParseDrainArguments) {
+    long long n;
+    string outputFile;
+
+    EXPECT_TRUE(parseDrainArgs("", n, outputFile));
+    EXPECT_EQ(n, 0);
+    EXPECT_TRUE(outputFile.empty());
+
+    EXPECT_TRUE(parseDrainArgs(" 500 --out drained.txt", n, outputFile));
+    EXPECT_EQ(n, 500);
+    EXPECT_EQ(outputFile, "drained.txt");
+
+    EXPECT_FALSE(parseDrainArgs(" --out", n, outputFile));
+    EXPECT_FALSE(parseDrainArgs(" -3", n, outputFile));
+    EXPECT_FALSE(parseDrainArgs(" 10x", n, outputFile));
+}
+
+TEST(RequestReplyTest, ParsePingPongCount) {
+    int iterations = 0;
+
+    EXPECT_TRUE(parsePingPongCount("1000", iterations));
+    EXPECT_EQ(iterations, 1000);
+
+    EXPECT_FALSE(parsePingPongCount("0", iterations));
+    EXPECT_FALSE(parsePingPongCount("-5", iterations));
+    EXPECT_FALSE(parsePingPongCount("abc", iterations));
+    EXPECT_FALSE(parsePingPongCount("10x", iterations));
+    EXPECT_FALSE(parsePingPongCount("99999999999", iterations));
+}
+
+TEST(PlacementTest, ParsePlacementSpecs) {
+    Placement placement;
+
+    EXPECT_TRUE(parsePlacement("any", placement));
+    EXPECT_FALSE(isPinned(placement));
+
+    EXPECT_TRUE(parsePlacement("node:1", placement));
+    EXPECT_EQ(placement.node, 1);
+    EXPECT_EQ(placement.cpuMask, 0u);
+
+    EXPECT_TRUE(parsePlacement("cpu:0,2-3", placement));
+    EXPECT_EQ(placement.node, ANY_NODE);
+    EXPECT_EQ(placement.cpuMask, (DWORD_PTR)0xD);
+
+    EXPECT_FALSE(parsePlacement("cpu:3-1", placement));
+    EXPECT_FALSE(parsePlacement("cpu:", placement));
+    EXPECT_FALSE(parsePlacement("node:-1", placement));
+    EXPECT_FALSE(parsePlacement("core:2", placement));
+}
+
+TEST(PlacementTest, RejectsNodesOutsideFirstProcessorGroup) {
+    GROUP_AFFINITY affinity = {};
+
+    EXPECT_NE(placementMask({ 0, 0 }), (DWORD_PTR)0);
+    for (USHORT node = 1; node < 64; ++node) {
+        if (GetNumaNodeProcessorMaskEx(node, &affinity) && affinity.Group != 0) {
+            EXPECT_EQ(placementMask({ node, 0 }), (DWORD_PTR)0);
+            EXPECT_FALSE(applyPlacement(GetCurrentProcess(), { node, 0 }, "test process"));
+        }
+    }
+}
+
+TEST(PlacementTest, ParseLaunchOptionsAssignsSendersRoundRobin) {
+    const char* argv[] = { "OS_LAB_4.exe", "--pin-receiver", "node:0", "--pin-senders", "cpu:1/cpu:2" };
+    LaunchOptions options;
+
+    ASSERT_TRUE(parseLaunchOptions(5, (char**)argv, 1, options));
+    EXPECT_EQ(options.receiver.node, 0);
+    EXPECT_TRUE(hasPinnedSenders(options));
+    EXPECT_EQ(senderPlacement(options, 0).cpuMask, (DWORD_PTR)0x2);
+    EXPECT_EQ(senderPlacement(options, 1).cpuMask, (DWORD_PTR)0x4);
+    EXPECT_EQ(senderPlacement(options, 2).cpuMask, (DWORD_PTR)0x2);
+
+    EXPECT_FALSE(parseLaunchOptions(4, (char**)argv, 1, options));
+    EXPECT_TRUE(parseLaunchOptions(1, (char**)argv, 1, options));
+    EXPECT_FALSE(isPinned(senderPlacement(options, 0)));
+}
+
+TEST_F(QueueFileTest, MappedViewIsCoherentWithFileIo) {
+    ASSERT_TRUE(initializeQueueFile(hFile, 4));
+
+    QueueHeader h;
+    ASSERT_TRUE(readQueueHeader(hFile, h));
+    ASSERT_TRUE(mapQueueFile(hFile, indexSectionEnd(h), NUMA_NO_PREFERRED_NODE));
+
+    HANDLE hOther = openFile("test_queue.bin");
+    ASSERT_NE(hOther, INVALID_HANDLE_VALUE);
+
+    ASSERT_TRUE(writeMessage(hOther, h, 2, "FromFile", { 5, 0, 0 }));
+    char buffer[MSG_SIZE + 1] = { 0 };
+    MessageMeta meta;
+    ASSERT_TRUE(readMessage(hFile, h, 2, buffer, &meta));
+    EXPECT_STREQ(buffer, "FromFile");
+    EXPECT_EQ(meta.senderId, 5);
+
+    h.count = 3;
+    ASSERT_TRUE(writeQueueHeader(hFile, h));
+    ASSERT_TRUE(flushQueueFile(hFile));
+
+    QueueHeader other;
+    ASSERT_TRUE(readQueueHeader(hOther, other));
+    EXPECT_EQ(other.count, 3);
+
+    unmapQueueFile(hFile);
+    CloseHandle(hOther);
+}
+
+TEST(FilterTest, ParseOverflowPolicy) {
+    int policy, blockTimeout;
+
+    EXPECT_TRUE(parseOverflowPolicy("block:250", policy, blockTimeout));
+    EXPECT_EQ(policy, OVERFLOW_BLOCK);
+    EXPECT_EQ(blockTimeout, 250);
+
+    EXPECT_TRUE(parseOverflowPolicy("drop-oldest", policy, blockTimeout));
+    EXPECT_EQ(policy, OVERFLOW_DROP_OLDEST);
+    EXPECT_TRUE(parseOverflowPolicy("fail", policy, blockTimeout));
+    EXPECT_EQ(policy, OVERFLOW_FAIL);
+
+    EXPECT_FALSE(parseOverflowPolicy("block:0", policy, blockTimeout));
+    EXPECT_FALSE(parseOverflowPolicy("drop", policy, blockTimeout));
+}
+
+TEST(QueueNameTest, NameIsDerivedFromFullPath) {
+    string name = queueNameFromPath("messages.bin");
+
+    EXPECT_EQ(queueNameFromPath("./messages.bin"), name);
+    EXPECT_NE(queueNameFromPath("other.bin"), name);
+    EXPECT_EQ(name.compare(0, 13, "messages.bin_"), 0);
+    EXPECT_TRUE(isValidQueueName(name));
+    EXPECT_FALSE(isValidQueueName(""));
+    EXPECT_FALSE(isValidQueueName("a\\b"));
+    EXPECT_FALSE(isValidQueueName("my queue"));
+    EXPECT_FALSE(isValidQueueName("a\"b"));
+    EXPECT_FALSE(isValidQueueName("tab\tname"));
+}
+
+TEST(QueueNameTest, ObjectNamesAreNamespaced) {
+    EXPECT_EQ(queueObjectName("QueueMutex"), "QueueMutex");
+
+    setQueueNamespace("orders");
+    EXPECT_EQ(queueObjectName("QueueMutex"), "QueueMutex@orders");
+    EXPECT_EQ(subscriberEventName(3), "SubscriberNotEmpty_3@orders");
+    setQueueNamespace("");
+}
+
+TEST(QueueNameTest, RegistryRejectsSecondLiveQueueWithSameName) {
+    string name = "registry_test_" + to_string(GetTickCount());
+
+    ASSERT_TRUE(registerQueue(name, "registry_test.bin"));
+    EXPECT_FALSE(registerQueue(name, "registry_test.bin"));
+
+    bool listed = false;
+    for (const RegistryEntry& entry : liveQueues()) {
+        listed = listed || (name == entry.name && entry.pid == GetCurrentProcessId());
+    }
+    EXPECT_TRUE(listed);
+
+    unregisterQueue(name);
+    EXPECT_TRUE(registerQueue(name, "registry_test.bin"));
+    unregisterQueue(name);
+}
+
+TEST(QueueNameTest, RegistryRejectsSecondLiveQueueOnSameFile) {
+    string name = "registry_test_" + to_string(GetTickCount());
+
+    ASSERT_TRUE(registerQueue(name, "registry_test.bin"));
+    EXPECT_FALSE(registerQueue(name + "_other", "registry_test.bin"));
+    EXPECT_FALSE(registerQueue(name + "_other", "./registry_test.bin"));
+    EXPECT_TRUE(registerQueue(name + "_other", "registry_other.bin"));
+
+    unregisterQueue(name + "_other");
+    unregisterQueue(name);
+    EXPECT_TRUE(registerQueue(name + "_other", "registry_test.bin"));
+    unregisterQueue(name + "_other");
+}
+
 TEST(ProcessTest, SignalSenderReady) {
     EXPECT_NO_THROW(signalSenderReady(0));
     EXPECT_NO_THROW(signalSenderReady(999));
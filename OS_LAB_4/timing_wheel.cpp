@@ -0,0 +1,316 @@
+#include "timing_wheel.h"
+#include "broadcast.h"
+#include "transaction.h"
+#include <climits>
+
+static LONGLONG stateOffset(const QueueHeader& header) {
+    return transactionSectionEnd(header);
+}
+
+static LONGLONG bucketsOffset(const QueueHeader& header) {
+    return stateOffset(header) + sizeof(WheelState);
+}
+
+static LONGLONG entryOffset(const QueueHeader& header, int entry) {
+    return bucketsOffset(header) + sizeof(WheelBuckets) + entry * sizeof(DelayedEntry);
+}
+
+LONGLONG wheelSectionEnd(const QueueHeader& header) {
+    return entryOffset(header, MAX_DELAYED);
+}
+
+bool readWheelState(HANDLE hFile, const QueueHeader& header, WheelState& state) {
+    return readBlock(hFile, stateOffset(header), &state, sizeof(state), "Failed to read timing wheel.");
+}
+
+bool writeWheelState(HANDLE hFile, const QueueHeader& header, const WheelState& state) {
+    return writeBlock(hFile, stateOffset(header), &state, sizeof(state), "Failed to write timing wheel.");
+}
+
+static bool readWheelBuckets(HANDLE hFile, const QueueHeader& header, WheelBuckets& buckets) {
+    return readBlock(hFile, bucketsOffset(header), &buckets, sizeof(buckets), "Failed to read timing wheel.");
+}
+
+static bool writeWheelBuckets(HANDLE hFile, const QueueHeader& header, const WheelBuckets& buckets) {
+    return writeBlock(hFile, bucketsOffset(header), &buckets, sizeof(buckets), "Failed to write timing wheel.");
+}
+
+static bool readEntry(HANDLE hFile, const QueueHeader& header, int entry, DelayedEntry& delayed) {
+    return readBlock(hFile, entryOffset(header, entry), &delayed, sizeof(delayed), "Failed to read delayed message.");
+}
+
+static bool writeEntryLink(HANDLE hFile, const QueueHeader& header, int entry, int link) {
+    return writeBlock(hFile, entryOffset(header, entry), &link, sizeof(link), "Failed to write delayed message link.");
+}
+
+static LONGLONG currentWheelTick() {
+    return (LONGLONG)(GetTickCount64() / WHEEL_TICK_MS);
+}
+
+static int bucketLevel(LONGLONG delta) {
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (1LL << (WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    return level;
+}
+
+static bool appendEntry(HANDLE hFile, const QueueHeader& header, IndexList& list, int entry) {
+    int link = entry + 1;
+    if (list.last != 0 && !writeEntryLink(hFile, header, list.last - 1, link)) {
+        return false;
+    }
+
+    if (list.last == 0) {
+        list.first = link;
+    }
+    list.last = link;
+    return true;
+}
+
+static bool scheduleEntry(HANDLE hFile, const QueueHeader& header, WheelState& state, WheelBuckets& buckets, int entry, LONGLONG dueTick) {
+    int level = bucketLevel(dueTick - state.currentTick);
+    int shift = WHEEL_BITS * level;
+
+    state.nextDeadline = min(state.nextDeadline, (dueTick >> shift) << shift);
+    return writeEntryLink(hFile, header, entry, 0) &&
+        appendEntry(hFile, header, buckets.levels[level][(dueTick >> shift) & (WHEEL_SIZE - 1)], entry);
+}
+
+static bool cascadeBucket(HANDLE hFile, const QueueHeader& header, WheelState& state, WheelBuckets& buckets, IndexList& bucket) {
+    int link = bucket.first;
+    bucket = IndexList();
+
+    while (link != 0) {
+        DelayedEntry delayed;
+        if (!readEntry(hFile, header, link - 1, delayed) ||
+            !scheduleEntry(hFile, header, state, buckets, link - 1, delayed.dueTick)) {
+            return false;
+        }
+        link = delayed.next;
+    }
+
+    return true;
+}
+
+static bool spliceList(HANDLE hFile, const QueueHeader& header, IndexList& to, IndexList& from) {
+    if (to.last != 0 && !writeEntryLink(hFile, header, to.last - 1, from.first)) {
+        return false;
+    }
+
+    if (to.last == 0) {
+        to.first = from.first;
+    }
+    to.last = from.last;
+    from = IndexList();
+    return true;
+}
+
+static LONGLONG nextBucketTick(const WheelState& state, const WheelBuckets& buckets) {
+    LONGLONG next = LLONG_MAX;
+
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        int shift = WHEEL_BITS * level;
+        for (int i = 1; i <= WHEEL_SIZE; ++i) {
+            LONGLONG tick = ((state.currentTick >> shift) + i) << shift;
+            if (buckets.levels[level][(tick >> shift) & (WHEEL_SIZE - 1)].first != 0) {
+                next = min(next, tick);
+                break;
+            }
+        }
+    }
+
+    return next;
+}
+
+static bool advanceWheel(HANDLE hFile, const QueueHeader& header, WheelState& state, LONGLONG now) {
+    WheelBuckets buckets;
+    if (!readWheelBuckets(hFile, header, buckets)) {
+        return false;
+    }
+
+    while (state.currentTick < now) {
+        if (state.currentTick + 1 < state.nextDeadline) {
+            state.currentTick = min(now, state.nextDeadline - 1);
+            continue;
+        }
+
+        state.currentTick++;
+        for (int level = WHEEL_LEVELS - 1; level > 0; --level) {
+            int shift = WHEEL_BITS * level;
+            if ((state.currentTick & ((1LL << shift) - 1)) == 0 &&
+                !cascadeBucket(hFile, header, state, buckets, buckets.levels[level][(state.currentTick >> shift) & (WHEEL_SIZE - 1)])) {
+                return false;
+            }
+        }
+
+        IndexList& expired = buckets.levels[0][state.currentTick & (WHEEL_SIZE - 1)];
+        if (expired.first != 0 && !spliceList(hFile, header, state.due, expired)) {
+            return false;
+        }
+
+        state.nextDeadline = nextBucketTick(state, buckets);
+    }
+
+    return writeWheelBuckets(hFile, header, buckets);
+}
+
+static bool deliverDueEntries(HANDLE hFile, QueueHeader& header, MessageIndex& index, WheelState& state, vector<MessageMeta>& delivered) {
+    while (state.due.first != 0 && header.count < header.capacity) {
+        int entry = state.due.first - 1;
+        DelayedEntry delayed;
+        if (!readEntry(hFile, header, entry, delayed)) {
+            return false;
+        }
+
+        string text(delayed.data, strnlen(delayed.data, MSG_SIZE));
+        if (!writeMessage(hFile, header, header.tail, text, delayed.meta) ||
+            !appendToIndex(hFile, header, index, header.tail, delayed.meta) ||
+            !writeEntryLink(hFile, header, entry, state.freeList)) {
+            return false;
+        }
+
+        header.tail = (header.tail + 1) % header.capacity;
+        header.count++;
+        delivered.push_back(delayed.meta);
+
+        state.due.first = delayed.next;
+        if (delayed.next == 0) {
+            state.due.last = 0;
+        }
+        state.freeList = entry + 1;
+        state.pending--;
+    }
+
+    return true;
+}
+
+bool promoteDueMessages(HANDLE hFile, HANDLE evNotEmpty, QueueHeader& header, MessageIndex& index) {
+    WheelState state;
+    if (!readWheelState(hFile, header, state)) {
+        return false;
+    }
+
+    LONGLONG now = currentWheelTick();
+    if (state.pending == 0 || (state.due.first == 0 && now < state.nextDeadline)) {
+        return true;
+    }
+
+    vector<MessageMeta> delivered;
+    if ((now >= state.nextDeadline && !advanceWheel(hFile, header, state, now)) ||
+        !deliverDueEntries(hFile, header, index, state, delivered) ||
+        !writeWheelState(hFile, header, state)) {
+        return false;
+    }
+
+    if (delivered.empty()) {
+        return true;
+    }
+
+    if (!writeMessageIndex(hFile, header, index) || !writeQueueHeader(hFile, header)) {
+        return false;
+    }
+
+    SetEvent(evNotEmpty);
+    for (const MessageMeta& meta : delivered) {
+        notifyFilterEvents(meta);
+    }
+    return true;
+}
+
+static int allocateEntry(HANDLE hFile, const QueueHeader& header, WheelState& state) {
+    if (state.freeList != 0) {
+        int entry = state.freeList - 1;
+        DelayedEntry delayed;
+        if (!readEntry(hFile, header, entry, delayed)) {
+            return -1;
+        }
+        state.freeList = delayed.next;
+        return entry;
+    }
+
+    if (state.allocated < MAX_DELAYED) {
+        return state.allocated++;
+    }
+
+    cout << "Delay queue is full, message rejected\n";
+    return -1;
+}
+
+static bool scheduleMessage(HANDLE hFile, const QueueHeader& header, const string& msg, const MessageMeta& meta, DWORD delay, bool& earlier) {
+    WheelState state;
+    WheelBuckets buckets;
+    if (!readWheelState(hFile, header, state) || !readWheelBuckets(hFile, header, buckets)) {
+        return false;
+    }
+
+    int entry = allocateEntry(hFile, header, state);
+    if (entry < 0) {
+        return false;
+    }
+
+    ULONGLONG now = GetTickCount64();
+    if (state.pending == 0) {
+        state.nextDeadline = LLONG_MAX;
+    }
+    LONGLONG previousDeadline = state.nextDeadline;
+    state.currentTick = max(state.currentTick, (LONGLONG)(now / WHEEL_TICK_MS));
+
+    DelayedEntry delayed = { 0, (LONGLONG)((now + delay + WHEEL_TICK_MS - 1) / WHEEL_TICK_MS), meta, { 0 } };
+    delayed.dueTick = max(delayed.dueTick, state.currentTick + 1);
+    memcpy(delayed.data, msg.c_str(), min(msg.size(), (size_t)MSG_SIZE));
+    state.pending++;
+
+    bool ok = writeBlock(hFile, entryOffset(header, entry), &delayed, sizeof(delayed), "Failed to write delayed message.") &&
+        scheduleEntry(hFile, header, state, buckets, entry, delayed.dueTick) &&
+        writeWheelBuckets(hFile, header, buckets) &&
+        writeWheelState(hFile, header, state);
+
+    earlier = state.nextDeadline < previousDeadline;
+    return ok;
+}
+
+bool enqueueDelayed(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, const string& msg, const MessageMeta& meta, DWORD delay) {
+    if (delay == 0 || delay > MAX_DELAY_MS) {
+        cout << "Delay must be between 1 and " << MAX_DELAY_MS << " ms\n";
+        return false;
+    }
+
+    if (!waitForObject(hMutex, "Waiting for mutex")) {
+        return false;
+    }
+
+    QueueHeader q;
+    BroadcastSection section;
+    MessageIndex index;
+    if (!readQueueHeader(hFile, q) || !readBroadcastSection(hFile, q, section) || !readMessageIndex(hFile, q, index)) {
+        ReleaseMutex(hMutex);
+        return false;
+    }
+
+    if (isBroadcastQueue(section)) {
+        cout << "Delayed delivery is not supported for broadcast queues\n";
+        ReleaseMutex(hMutex);
+        return false;
+    }
+
+    bool earlier = false;
+    bool ok = promoteDueMessages(hFile, evNotEmpty, q, index) && scheduleMessage(hFile, q, msg, meta, delay, earlier);
+    ReleaseMutex(hMutex);
+
+    if (ok && earlier) {
+        SetEvent(evNotEmpty);
+        notifyFilterEvents(meta);
+    }
+    return ok;
+}
+
+DWORD delayedWakeTime(HANDLE hFile, const QueueHeader& header) {
+    WheelState state;
+    if (!readWheelState(hFile, header, state) || state.pending == 0 || state.nextDeadline == LLONG_MAX) {
+        return INFINITE;
+    }
+
+    LONGLONG wait = state.nextDeadline * WHEEL_TICK_MS - (LONGLONG)GetTickCount64();
+    return (DWORD)max((LONGLONG)0, min(wait, (LONGLONG)INFINITE - 1));
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "message_index.h"
+
+using namespace std;
+
+const int WHEEL_BITS = 6;
+const int WHEEL_SIZE = 1 << WHEEL_BITS;
+const int WHEEL_LEVELS = 3;
+const int WHEEL_TICK_MS = 10;
+const DWORD MAX_DELAY_MS = WHEEL_TICK_MS * ((1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1);
+const int MAX_DELAYED = 256;
+
+#pragma pack(push,1)
+struct WheelState {
+    LONGLONG currentTick;
+    LONGLONG nextDeadline;
+    int pending;
+    int allocated;
+    int freeList;
+    IndexList due;
+};
+
+struct WheelBuckets {
+    IndexList levels[WHEEL_LEVELS][WHEEL_SIZE];
+};
+
+struct DelayedEntry {
+    int next;
+    LONGLONG dueTick;
+    MessageMeta meta;
+    char data[MSG_SIZE];
+};
+#pragma pack(pop)
+
+LONGLONG wheelSectionEnd(const QueueHeader& header);
+bool readWheelState(HANDLE hFile, const QueueHeader& header, WheelState& state);
+bool writeWheelState(HANDLE hFile, const QueueHeader& header, const WheelState& state);
+
+bool enqueueDelayed(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, const string& msg, const MessageMeta& meta, DWORD delay);
+bool promoteDueMessages(HANDLE hFile, HANDLE evNotEmpty, QueueHeader& header, MessageIndex& index);
+DWORD delayedWakeTime(HANDLE hFile, const QueueHeader& header);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "transaction.h"
+#include "broadcast.h"
+#include "batch_io.h"
+#include "overflow.h"
+
+static LONGLONG transactionOffset(const QueueHeader& header) {
+    return indexSectionEnd(header);
+}
+
+LONGLONG transactionSectionEnd(const QueueHeader& header) {
+    return transactionOffset(header) + sizeof(TransactionTable);
+}
+
+bool readTransactionTable(HANDLE hFile, const QueueHeader& header, TransactionTable& table) {
+    return readBlock(hFile, transactionOffset(header), &table, sizeof(table), "Failed to read transaction table.");
+}
+
+bool writeTransactionTable(HANDLE hFile, const QueueHeader& header, const TransactionTable& table) {
+    return writeBlock(hFile, transactionOffset(header), &table, sizeof(table), "Failed to write transaction table.");
+}
+
+static bool coversSlot(const QueueHeader& header, const TransactionEntry& entry, int slot) {
+    return entry.count > 0 && (slot - entry.firstSlot + header.capacity) % header.capacity < entry.count;
+}
+
+static void setSlotStates(vector<char>& slots, int from, int to, int state) {
+    for (int i = from; i < to; ++i) {
+        memcpy(slots.data() + i * SLOT_SIZE, &state, sizeof(state));
+    }
+}
+
+bool beginTransaction(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, int size, Transaction& txn, DWORD timeout) {
+    DWORD started = GetTickCount();
+
+    while (true) {
+        if (!waitForObject(hMutex, "Waiting for mutex")) {
+            return false;
+        }
+
+        QueueHeader q;
+        BroadcastSection section;
+        TransactionTable table;
+        if (!readQueueHeader(hFile, q) || !readBroadcastSection(hFile, q, section) || !readTransactionTable(hFile, q, table)) {
+            ReleaseMutex(hMutex);
+            return false;
+        }
+
+        if (isBroadcastQueue(section) || size <= 0 || size > min(q.capacity, MAX_BATCH)) {
+            cout << "Transaction of " << size << " messages is not possible in this queue\n";
+            ReleaseMutex(hMutex);
+            return false;
+        }
+
+        if (q.capacity - q.count < size) {
+            ResetEvent(evNotFull);
+            ReleaseMutex(hMutex);
+            if (!waitForSpace(hFile, hMutex, evNotFull, q, started, timeout)) {
+                return false;
+            }
+            continue;
+        }
+
+        int entry = 0;
+        while (entry < MAX_TRANSACTIONS && table.entries[entry].count != 0) {
+            entry++;
+        }
+        if (entry == MAX_TRANSACTIONS) {
+            cout << "Too many open transactions\n";
+            ReleaseMutex(hMutex);
+            return false;
+        }
+
+        txn.entry = entry;
+        txn.header = q;
+        txn.firstSlot = q.tail;
+        txn.reserved = size;
+        txn.staged = 0;
+        txn.slots.assign(size * SLOT_SIZE, 0);
+        setSlotStates(txn.slots, 0, size, SLOT_RESERVED);
+
+        table.entries[entry] = { GetCurrentProcessId(), q.tail, size };
+        q.tail = (q.tail + size) % q.capacity;
+        q.count += size;
+
+        bool ok = writeSlots(hFile, q, txn.firstSlot, size, txn.slots.data()) &&
+            writeTransactionTable(hFile, q, table) &&
+            writeQueueHeader(hFile, q);
+
+        ReleaseMutex(hMutex);
+        return ok;
+    }
+}
+
+bool stageMessage(HANDLE hFile, Transaction& txn, const string& msg, const MessageMeta& meta) {
+    if (txn.staged == txn.reserved) {
+        cout << "All " << txn.reserved << " reserved slots are already staged\n";
+        return false;
+    }
+
+    char* slot = txn.slots.data() + txn.staged * SLOT_SIZE;
+    SlotHeader slotHeader = { SLOT_RESERVED, meta, 0, 0 };
+    memset(slot, 0, SLOT_SIZE);
+    memcpy(slot, &slotHeader, sizeof(slotHeader));
+    memcpy(slot + sizeof(SlotHeader), msg.c_str(), min(msg.size(), (size_t)MSG_SIZE));
+
+    int index = (txn.firstSlot + txn.staged) % txn.header.capacity;
+    if (!writeBlock(hFile, slotOffset(txn.header, index), slot, SLOT_SIZE, "Failed to stage message.")) {
+        return false;
+    }
+
+    txn.staged++;
+    return true;
+}
+
+static bool finishTransaction(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, Transaction& txn, int visible) {
+    if (txn.entry < 0) {
+        cout << "No open transaction\n";
+        return false;
+    }
+
+    if (!waitForObject(hMutex, "Waiting for mutex")) {
+        return false;
+    }
+
+    QueueHeader q;
+    MessageIndex index;
+    TransactionTable table;
+    if (!readQueueHeader(hFile, q) || !readMessageIndex(hFile, q, index) || !readTransactionTable(hFile, q, table)) {
+        ReleaseMutex(hMutex);
+        return false;
+    }
+
+    TransactionEntry& entry = table.entries[txn.entry];
+    if (entry.ownerPid != GetCurrentProcessId() || entry.firstSlot != txn.firstSlot || entry.count != txn.reserved) {
+        cout << "Transaction was released by the receiver\n";
+        ReleaseMutex(hMutex);
+        txn.entry = -1;
+        return false;
+    }
+
+    int unused = txn.reserved - visible;
+    bool atTail = q.tail == (txn.firstSlot + txn.reserved) % q.capacity;
+
+    setSlotStates(txn.slots, 0, visible, SLOT_READY);
+    setSlotStates(txn.slots, visible, txn.reserved, atTail ? SLOT_EMPTY : SLOT_CONSUMED);
+    entry = TransactionEntry();
+
+    if (atTail) {
+        q.tail = (q.tail - unused + q.capacity) % q.capacity;
+        q.count -= unused;
+    }
+    else {
+        index.holes += unused;
+    }
+
+    bool ok = appendBatchToIndex(hFile, q, index, txn.firstSlot, visible, txn.slots.data()) &&
+        writeSlots(hFile, q, txn.firstSlot, txn.reserved, txn.slots.data()) &&
+        skipConsumedAtHead(hFile, q, index) &&
+        writeMessageIndex(hFile, q, index) &&
+        writeTransactionTable(hFile, q, table) &&
+        writeQueueHeader(hFile, q);
+
+    ReleaseMutex(hMutex);
+    if (!ok) {
+        return false;
+    }
+
+    if (index.live > 0) {
+        SetEvent(evNotEmpty);
+    }
+    if (q.count < q.capacity) {
+        SetEvent(evNotFull);
+    }
+    for (int i = 0; i < visible; ++i) {
+        SlotHeader slotHeader;
+        memcpy(&slotHeader, txn.slots.data() + i * SLOT_SIZE, sizeof(slotHeader));
+        notifyFilterEvents(slotHeader.meta);
+    }
+
+    txn.entry = -1;
+    return true;
+}
+
+bool commitTransaction(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, Transaction& txn) {
+    return finishTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn, txn.staged);
+}
+
+bool abortTransaction(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, Transaction& txn) {
+    return finishTransaction(hFile, hMutex, evNotEmpty, evNotFull, txn, 0);
+}
+
+TakeResult releaseAbandonedTransaction(HANDLE hFile, QueueHeader& header, MessageIndex& index, int slot) {
+    TransactionTable table;
+    if (!readTransactionTable(hFile, header, table)) {
+        return TAKE_ERROR;
+    }
+
+    for (TransactionEntry& entry : table.entries) {
+        if (!coversSlot(header, entry, slot)) {
+            continue;
+        }
+
+        if (isProcessAlive(entry.ownerPid)) {
+            return TAKE_EMPTY;
+        }
+
+        vector<char> slots(entry.count * SLOT_SIZE);
+        if (!readSlots(hFile, header, entry.firstSlot, entry.count, slots.data())) {
+            return TAKE_ERROR;
+        }
+
+        cout << "Released " << entry.count << " slots reserved by exited process " << entry.ownerPid << "\n";
+        setSlotStates(slots, 0, entry.count, SLOT_CONSUMED);
+        index.holes += entry.count;
+        int first = entry.firstSlot;
+        int count = entry.count;
+        entry = TransactionEntry();
+
+        return writeSlots(hFile, header, first, count, slots.data()) && writeTransactionTable(hFile, header, table)
+            ? TAKE_OK : TAKE_ERROR;
+    }
+
+    index.holes++;
+    return writeSlotState(hFile, header, slot, SLOT_CONSUMED) ? TAKE_OK : TAKE_ERROR;
+}
+
+HANDLE openReservationOwner(HANDLE hFile, const QueueHeader& header, int slot) {
+    TransactionTable table;
+    if (!readTransactionTable(hFile, header, table)) {
+        return NULL;
+    }
+
+    for (const TransactionEntry& entry : table.entries) {
+        if (coversSlot(header, entry, slot)) {
+            return OpenProcess(SYNCHRONIZE, FALSE, entry.ownerPid);
+        }
+    }
+    return NULL;
+}
+
+bool waitForMessages(HANDLE evWait, HANDLE hOwner, DWORD started, DWORD timeout, DWORD wakeAfter) {
+    DWORD elapsed = GetTickCount() - started;
+    DWORD remaining = timeout == INFINITE ? INFINITE : elapsed < timeout ? timeout - elapsed : 0;
+
+    if (!hOwner && wakeAfter >= remaining) {
+        return waitForObject(evWait, "Waiting for messages", remaining);
+    }
+
+    HANDLE handles[] = { evWait, hOwner };
+    DWORD waitResult = WaitForMultipleObjects(hOwner ? 2 : 1, handles, FALSE, min(remaining, wakeAfter));
+    if (waitResult == WAIT_TIMEOUT && wakeAfter < remaining) {
+        return true;
+    }
+    if (waitResult != WAIT_OBJECT_0 && waitResult != WAIT_OBJECT_0 + 1) {
+        cout << "Waiting for messages timeout or error\n";
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include <windows.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "queue_file.h"
+#include "sync_utils.h"
+#include "message_index.h"
+
+using namespace std;
+
+const int MAX_TRANSACTIONS = 16;
+
+#pragma pack(push,1)
+struct TransactionEntry {
+    DWORD ownerPid;
+    int firstSlot;
+    int count;
+};
+
+struct TransactionTable {
+    TransactionEntry entries[MAX_TRANSACTIONS];
+};
+#pragma pack(pop)
+
+struct Transaction {
+    int entry = -1;
+    QueueHeader header = {};
+    int firstSlot = 0;
+    int reserved = 0;
+    int staged = 0;
+    vector<char> slots;
+};
+
+LONGLONG transactionSectionEnd(const QueueHeader& header);
+bool readTransactionTable(HANDLE hFile, const QueueHeader& header, TransactionTable& table);
+bool writeTransactionTable(HANDLE hFile, const QueueHeader& header, const TransactionTable& table);
+
+bool beginTransaction(HANDLE hFile, HANDLE hMutex, HANDLE evNotFull, int size, Transaction& txn, DWORD timeout = 5000);
+bool stageMessage(HANDLE hFile, Transaction& txn, const string& msg, const MessageMeta& meta);
+bool commitTransaction(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, Transaction& txn);
+bool abortTransaction(HANDLE hFile, HANDLE hMutex, HANDLE evNotEmpty, HANDLE evNotFull, Transaction& txn);
+
+TakeResult releaseAbandonedTransaction(HANDLE hFile, QueueHeader& header, MessageIndex& index, int slot);
+HANDLE openReservationOwner(HANDLE hFile, const QueueHeader& header, int slot);
+bool waitForMessages(HANDLE evWait, HANDLE hOwner, DWORD started, DWORD timeout, DWORD wakeAfter = INFINITE);
+
+#endif
\ No newline at end of file